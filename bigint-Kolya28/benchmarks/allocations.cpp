@@ -0,0 +1,113 @@
+#include "../big_integer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+namespace {
+size_t allocations = 0;
+constexpr size_t ITERATIONS = 1'000'000;
+// big_integer keeps up to 4 limbs of 32 bits inline
+constexpr int INLINE_BITS = 4 * 32;
+
+struct measurement {
+  double allocations_per_op;
+  double ns_per_op;
+};
+
+measurement run(const std::function<void()>& op) {
+  op();
+  size_t allocations_before = allocations;
+  auto clock_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i != ITERATIONS; ++i) {
+    op();
+  }
+  auto clock_end = std::chrono::steady_clock::now();
+  double elapsed_ns = std::chrono::duration<double, std::nano>(clock_end - clock_start).count();
+  return {static_cast<double>(allocations - allocations_before) / ITERATIONS, elapsed_ns / ITERATIONS};
+}
+
+// operands of at most two limbs, stored inline
+struct small_operands {
+  big_integer one_limb = 123'456'789;
+  big_integer two_limbs = 987'654'321'012'345'678LL;
+  big_integer negative = -5'000'000'000LL;
+};
+
+// operands just above the inline capacity, kept on the heap as every value was before the inline storage
+struct heap_operands {
+  big_integer one_limb = (big_integer(1) << (INLINE_BITS + 32)) + 123'456'789;
+  big_integer two_limbs = (big_integer(1) << (INLINE_BITS + 96)) - 12'345;
+  big_integer negative = -(big_integer(1) << (INLINE_BITS + 32));
+};
+
+template <typename Op>
+void report(const char* name, small_operands& small, heap_operands& heap, const Op& op) {
+  measurement inline_path = run([&] { op(small); });
+  measurement heap_path = run([&] { op(heap); });
+  std::printf("%-24s %10.2f %10.1f %10.2f %10.1f\n", name, inline_path.allocations_per_op, inline_path.ns_per_op,
+              heap_path.allocations_per_op, heap_path.ns_per_op);
+}
+
+void report(const char* name, const std::function<void()>& op) {
+  measurement m = run(op);
+  std::printf("%-24s %10.2f %10.1f\n", name, m.allocations_per_op, m.ns_per_op);
+}
+} // namespace
+
+void* operator new(size_t size) {
+  ++allocations;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+int main() {
+  small_operands small;
+  heap_operands heap;
+  big_integer large_a = (big_integer(1) << 2000) - 12345;
+  big_integer large_b = (big_integer(1) << 1900) + 777;
+  big_integer large_c = -(big_integer(1) << 3000);
+  big_integer result;
+
+  std::printf("%-24s %21s %21s\n", "", "inline operands", "heap operands");
+  std::printf("%-24s %10s %10s %10s %10s\n", "operation", "allocs/op", "ns/op", "allocs/op", "ns/op");
+  report("copy", small, heap, [&](auto& x) { result = big_integer(x.two_limbs); });
+  report("a + b", small, heap, [&](auto& x) { result = x.one_limb + x.two_limbs; });
+  report("a - b", small, heap, [&](auto& x) { result = x.one_limb - x.negative; });
+  report("a * b", small, heap, [&](auto& x) { result = x.two_limbs * x.negative; });
+  report("a / b", small, heap, [&](auto& x) { result = x.two_limbs / x.one_limb; });
+  report("a % b", small, heap, [&](auto& x) { result = x.two_limbs % x.one_limb; });
+  report("(a + b) * int", small, heap, [&](auto& x) { result = (x.one_limb + x.two_limbs) * 1000; });
+  report("(a + b) / c", small, heap, [&](auto& x) { result = (x.one_limb + x.two_limbs) / x.negative; });
+  report("a + int", small, heap, [&](auto& x) { result = x.two_limbs + 1; });
+  report("a += b", small, heap, [&](auto& x) { (result = x.two_limbs) += x.one_limb; });
+  report("a *= int", small, heap, [&](auto& x) { (result = x.one_limb) *= 1000; });
+  report("a & b", small, heap, [&](auto& x) { result = x.two_limbs & x.negative; });
+  report("a | b", small, heap, [&](auto& x) { result = x.two_limbs | x.negative; });
+  report("a << 17", small, heap, [&](auto& x) { result = x.two_limbs << 17; });
+  report("a >> 17", small, heap, [&](auto& x) { result = x.negative >> 17; });
+  report("++a", small, heap, [&](auto& x) { ++(result = x.two_limbs); });
+  report("-a", small, heap, [&](auto& x) { result = -x.two_limbs; });
+  report("a < b", small, heap, [&](auto& x) { result = big_integer(x.one_limb < x.two_limbs); });
+
+  std::printf("\n%-24s %10s %10s\n", "operation", "allocs/op", "ns/op");
+  report("ctor(int)", [&] { result = big_integer(42); });
+  report("ctor(long long)", [&] { result = big_integer(-9'000'000'000LL); });
+  report("A * B (large)", [&] { result = large_a * large_b; });
+  report("A * B + C - A (large)", [&] { result = large_a * large_b + large_c - large_a; });
+  report("(A + B) * C (large)", [&] { result = (large_a + large_b) * large_c; });
+  report("A - B ^ C (large)", [&] { result = large_a - (large_b ^ large_c); });
+  return result == 0;
+}
@@ -0,0 +1,131 @@
+#include "../big_integer.h"
+#include "../ci-extra/big_integer_gmp.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace {
+constexpr int64_t MAX_LIMBS = 100'000;
+constexpr size_t LIMB_BITS = 32;
+
+void limb_sizes(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(10)->Range(1, MAX_LIMBS)->Unit(benchmark::kMicrosecond);
+}
+
+std::string random_decimal(int64_t limbs, unsigned seed) {
+  std::default_random_engine rng(seed);
+  big_integer_gmp value;
+  value.random(static_cast<size_t>(limbs) * LIMB_BITS, rng);
+  return to_string(value);
+}
+
+template <typename T>
+T random_value(int64_t limbs, unsigned seed) {
+  return T(random_decimal(limbs, seed));
+}
+
+template <typename T, typename Operation>
+void binary_operation(benchmark::State& state, int64_t a_limbs, int64_t b_limbs, Operation op) {
+  T a = random_value<T>(a_limbs, 1);
+  T b = random_value<T>(b_limbs, 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(op(a, b));
+  }
+}
+
+template <typename T>
+void add(benchmark::State& state) {
+  binary_operation<T>(state, state.range(0), state.range(0), [](const T& a, const T& b) { return a + b; });
+}
+
+template <typename T>
+void sub(benchmark::State& state) {
+  binary_operation<T>(state, state.range(0), state.range(0), [](const T& a, const T& b) { return a - b; });
+}
+
+template <typename T>
+void mul(benchmark::State& state) {
+  binary_operation<T>(state, state.range(0), state.range(0), [](const T& a, const T& b) { return a * b; });
+}
+
+template <typename T>
+void div(benchmark::State& state) {
+  binary_operation<T>(state, 2 * state.range(0), state.range(0), [](const T& a, const T& b) { return a / b; });
+}
+
+template <typename T>
+void bitwise_and(benchmark::State& state) {
+  binary_operation<T>(state, state.range(0), state.range(0), [](const T& a, const T& b) { return a & b; });
+}
+
+template <typename T>
+void bitwise_or(benchmark::State& state) {
+  binary_operation<T>(state, state.range(0), state.range(0), [](const T& a, const T& b) { return a | b; });
+}
+
+template <typename T>
+void bitwise_xor(benchmark::State& state) {
+  binary_operation<T>(state, state.range(0), state.range(0), [](const T& a, const T& b) { return a ^ b; });
+}
+
+template <typename T>
+void shl(benchmark::State& state) {
+  T a = random_value<T>(state.range(0), 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a << 77);
+  }
+}
+
+template <typename T>
+void shr(benchmark::State& state) {
+  T a = random_value<T>(state.range(0), 1);
+  int shift = static_cast<int>(state.range(0) * LIMB_BITS / 2 + 7);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(a >> shift);
+  }
+}
+
+template <typename T>
+void to_string(benchmark::State& state) {
+  T a = random_value<T>(state.range(0), 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(to_string(a));
+  }
+}
+
+template <typename T>
+void parse(benchmark::State& state) {
+  std::string str = random_decimal(state.range(0), 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(T(str));
+  }
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(add, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(add, big_integer_gmp)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(sub, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(sub, big_integer_gmp)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(mul, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(mul, big_integer_gmp)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(div, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(div, big_integer_gmp)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(bitwise_and, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(bitwise_and, big_integer_gmp)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(bitwise_or, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(bitwise_or, big_integer_gmp)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(bitwise_xor, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(bitwise_xor, big_integer_gmp)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(shl, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(shl, big_integer_gmp)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(shr, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(shr, big_integer_gmp)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(to_string, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(to_string, big_integer_gmp)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(parse, big_integer)->Apply(limb_sizes);
+BENCHMARK_TEMPLATE(parse, big_integer_gmp)->Apply(limb_sizes);
+
+BENCHMARK_MAIN();
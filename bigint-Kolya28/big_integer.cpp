@@ -1,17 +1,504 @@
 #include "big_integer.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <charconv>
 #include <cmath>
 #include <cstddef>
 #include <cstring>
+#include <deque>
+#include <iterator>
 #include <ostream>
 #include <stdexcept>
+#include <vector>
+
+namespace {
+using digit_type = uint32_t;
+using double_digit_type = uint64_t;
+constexpr size_t DIGIT_BITS = std::numeric_limits<digit_type>::digits;
+
+constexpr size_t KARATSUBA_THRESHOLD = 32;
+constexpr size_t TOOM3_THRESHOLD = 384;
+constexpr size_t SQR_KARATSUBA_THRESHOLD = 64;
+
+// r[0, an) = a[0, an) + b[0, bn), bn <= an, returns carry, r may alias a or b
+digit_type add(digit_type* r, const digit_type* a, size_t an, const digit_type* b, size_t bn) {
+  assert(bn <= an);
+  double_digit_type carry = 0;
+  size_t i = 0;
+  for (; i < bn; ++i) {
+    carry += static_cast<double_digit_type>(a[i]) + b[i];
+    r[i] = static_cast<digit_type>(carry);
+    carry >>= DIGIT_BITS;
+  }
+  for (; i < an; ++i) {
+    carry += a[i];
+    r[i] = static_cast<digit_type>(carry);
+    carry >>= DIGIT_BITS;
+  }
+  return static_cast<digit_type>(carry);
+}
+
+// r[0, an) = a[0, an) - b[0, bn), bn <= an, returns borrow, r may alias a or b
+digit_type sub(digit_type* r, const digit_type* a, size_t an, const digit_type* b, size_t bn) {
+  assert(bn <= an);
+  double_digit_type borrow = 0;
+  size_t i = 0;
+  for (; i < bn; ++i) {
+    double_digit_type diff = static_cast<double_digit_type>(a[i]) - b[i] - borrow;
+    borrow = diff >> (2 * DIGIT_BITS - 1);
+    r[i] = static_cast<digit_type>(diff);
+  }
+  for (; i < an; ++i) {
+    double_digit_type diff = static_cast<double_digit_type>(a[i]) - borrow;
+    borrow = diff >> (2 * DIGIT_BITS - 1);
+    r[i] = static_cast<digit_type>(diff);
+  }
+  return static_cast<digit_type>(borrow);
+}
+
+// r[0, n) = a[0, n) * b, returns carry
+digit_type mul_1(digit_type* r, const digit_type* a, size_t n, digit_type b) {
+  double_digit_type carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    carry += static_cast<double_digit_type>(a[i]) * b;
+    r[i] = static_cast<digit_type>(carry);
+    carry >>= DIGIT_BITS;
+  }
+  return static_cast<digit_type>(carry);
+}
+
+// r[0, n) += a[0, n) * b, returns carry
+digit_type addmul_1(digit_type* r, const digit_type* a, size_t n, digit_type b) {
+  double_digit_type carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    carry += static_cast<double_digit_type>(a[i]) * b + r[i];
+    r[i] = static_cast<digit_type>(carry);
+    carry >>= DIGIT_BITS;
+  }
+  return static_cast<digit_type>(carry);
+}
+
+// r[0, n) -= a[0, n) * b, returns borrow
+digit_type submul_1(digit_type* r, const digit_type* a, size_t n, digit_type b) {
+  double_digit_type borrow = 0;
+  for (size_t i = 0; i < n; ++i) {
+    double_digit_type prod = static_cast<double_digit_type>(a[i]) * b + borrow;
+    auto low = static_cast<digit_type>(prod);
+    borrow = (prod >> DIGIT_BITS) + (r[i] < low);
+    r[i] -= low;
+  }
+  return static_cast<digit_type>(borrow);
+}
+
+// a[0, n) /= d, returns remainder
+digit_type divide_1(digit_type* a, size_t n, digit_type d) {
+  double_digit_type remainder = 0;
+  for (size_t i = n; i-- > 0;) {
+    remainder = (remainder << DIGIT_BITS) | a[i];
+    a[i] = static_cast<digit_type>(remainder / d);
+    remainder %= d;
+  }
+  return static_cast<digit_type>(remainder);
+}
+
+// r[0, n) = a[0, n) << shift, shift < DIGIT_BITS, returns the bits shifted out, r may overlap a from above
+digit_type lshift(digit_type* r, const digit_type* a, size_t n, size_t shift) {
+  assert(n > 0 && shift < DIGIT_BITS);
+  if (shift == 0) {
+    std::copy_backward(a, a + n, r + n);
+    return 0;
+  }
+  digit_type out = a[n - 1] >> (DIGIT_BITS - shift);
+  for (size_t i = n - 1; i > 0; --i) {
+    r[i] = (a[i] << shift) | (a[i - 1] >> (DIGIT_BITS - shift));
+  }
+  r[0] = a[0] << shift;
+  return out;
+}
+
+// r[0, n) = a[0, n) >> shift, shift < DIGIT_BITS, returns the bits shifted out, r may overlap a from below
+digit_type rshift(digit_type* r, const digit_type* a, size_t n, size_t shift) {
+  assert(n > 0 && shift < DIGIT_BITS);
+  if (shift == 0) {
+    std::copy(a, a + n, r);
+    return 0;
+  }
+  digit_type out = a[0] << (DIGIT_BITS - shift);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    r[i] = (a[i] >> shift) | (a[i + 1] << (DIGIT_BITS - shift));
+  }
+  r[n - 1] = a[n - 1] >> shift;
+  return out;
+}
+
+// r[0, an) = |a[0, an) - b[0, bn)|, bn <= an, returns a < b
+bool abs_diff(digit_type* r, const digit_type* a, size_t an, const digit_type* b, size_t bn) {
+  assert(bn <= an);
+  bool less = std::all_of(a + bn, a + an, [](digit_type d) { return d == 0; }) &&
+              std::lexicographical_compare(std::make_reverse_iterator(a + bn), std::make_reverse_iterator(a),
+                                           std::make_reverse_iterator(b + bn), std::make_reverse_iterator(b));
+  if (less) {
+    sub(r, b, bn, a, bn);
+    std::fill(r + bn, r + an, 0);
+  } else {
+    sub(r, a, an, b, bn);
+  }
+  return less;
+}
+
+// r[offset, rn) += a[0, an), the sum is known to fit into rn limbs
+void add_shifted(digit_type* r, size_t rn, size_t offset, const digit_type* a, size_t an) {
+  assert(offset <= rn);
+  size_t len = std::min(an, rn - offset);
+  assert(std::all_of(a + len, a + an, [](digit_type d) { return d == 0; }));
+  [[maybe_unused]] digit_type carry = add(r + offset, r + offset, rn - offset, a, len);
+  assert(carry == 0);
+}
+
+// r[0, an + bn) = a[0, an) * b[0, bn)
+void mul_basecase(digit_type* r, const digit_type* a, size_t an, const digit_type* b, size_t bn) {
+  r[an] = mul_1(r, a, an, b[0]);
+  for (size_t i = 1; i < bn; ++i) {
+    r[an + i] = addmul_1(r + i, a, an, b[i]);
+  }
+}
+
+size_t mul_balanced_scratch_size(size_t n) {
+  if (n < KARATSUBA_THRESHOLD) {
+    return 0;
+  }
+  if (n < TOOM3_THRESHOLD) {
+    size_t h = n - n / 2;
+    return 4 * h + std::max({size_t{1}, mul_balanced_scratch_size(h), mul_balanced_scratch_size(n - h)});
+  }
+  size_t k = (n + 2) / 3;
+  return 10 * (k + 1) + std::max({mul_balanced_scratch_size(k + 1), mul_balanced_scratch_size(k),
+                                  mul_balanced_scratch_size(n - 2 * k)});
+}
+
+size_t mul_scratch_size(size_t an, size_t bn) {
+  assert(an >= bn);
+  if (bn < KARATSUBA_THRESHOLD) {
+    return 0;
+  }
+  if (an == bn) {
+    return mul_balanced_scratch_size(bn);
+  }
+  size_t tail = an % bn;
+  size_t tail_scratch = tail == 0 ? 0 : mul_scratch_size(bn, tail);
+  return 2 * bn + std::max(mul_balanced_scratch_size(bn), tail_scratch);
+}
+
+// scratch for mul of an x bn limbs, kept per thread so that a product allocates nothing but its result
+digit_type* mul_scratch(size_t an, size_t bn) {
+  thread_local std::vector<digit_type> scratch;
+  size_t size = mul_scratch_size(an, bn);
+  if (scratch.size() < size) {
+    scratch.clear();
+    scratch.resize(size);
+  }
+  return scratch.data();
+}
+
+void mul_balanced(digit_type* r, const digit_type* a, const digit_type* b, size_t n, digit_type* scratch);
+
+// a = a1 * B^h + a0, b = b1 * B^h + b0
+// a * b = z2 * B^2h + (z0 + z2 - (a0 - a1) * (b0 - b1)) * B^h + z0
+void mul_karatsuba(digit_type* r, const digit_type* a, const digit_type* b, size_t n, digit_type* scratch) {
+  size_t h = n - n / 2;
+  size_t l = n - h;
+
+  mul_balanced(r, a, b, h, scratch);
+  mul_balanced(r + 2 * h, a + h, b + h, l, scratch);
+
+  digit_type* prod = scratch;
+  digit_type* a_diff = scratch + 2 * h;
+  digit_type* b_diff = scratch + 3 * h;
+  bool prod_negative = abs_diff(a_diff, a, h, a + h, l) != abs_diff(b_diff, b, h, b + h, l);
+  mul_balanced(prod, a_diff, b_diff, h, scratch + 4 * h);
+
+  digit_type* mid = scratch + 2 * h;
+  std::copy_n(r, 2 * h, mid);
+  mid[2 * h] = add(mid, mid, 2 * h, r + 2 * h, 2 * l);
+  if (prod_negative) {
+    add(mid, mid, 2 * h + 1, prod, 2 * h);
+  } else {
+    sub(mid, mid, 2 * h + 1, prod, 2 * h);
+  }
+  add_shifted(r, 2 * n, h, mid, 2 * h + 1);
+}
+
+// a = a2 * x^2 + a1 * x + a0, x = B^k; the product polynomial is evaluated at 0, 1, -1, 2, inf
+void mul_toom3(digit_type* r, const digit_type* a, const digit_type* b, size_t n, digit_type* scratch) {
+  size_t k = (n + 2) / 3;
+  size_t top = n - 2 * k;
+  size_t len = 2 * k + 2;
+
+  digit_type* w1 = scratch;
+  digit_type* wm1 = w1 + len;
+  digit_type* w2 = wm1 + len;
+  digit_type* a_eval = w2 + len;
+  digit_type* b_eval = a_eval + (k + 1);
+  digit_type* a_eval2 = b_eval + (k + 1);
+  digit_type* b_eval2 = a_eval2 + (k + 1);
+  digit_type* next_scratch = b_eval2 + (k + 1);
+
+  auto evaluate = [k, top](const digit_type* x, digit_type* at_1, digit_type* at_m1) {
+    at_m1[k] = add(at_m1, x, k, x + 2 * k, top);
+    at_1[k] = at_m1[k] + add(at_1, at_m1, k, x + k, k);
+    return abs_diff(at_m1, at_m1, k + 1, x + k, k);
+  };
+  bool a_negative = evaluate(a, a_eval2, a_eval);
+  bool b_negative = evaluate(b, b_eval2, b_eval);
+  bool wm1_negative = a_negative != b_negative;
+
+  mul_balanced(w1, a_eval2, b_eval2, k + 1, next_scratch);
+  mul_balanced(wm1, a_eval, b_eval, k + 1, next_scratch);
+
+  auto evaluate_at_2 = [k, top](const digit_type* x, digit_type* at_2) {
+    std::copy_n(x, k, at_2);
+    at_2[k] = addmul_1(at_2, x + k, k, 2);
+    digit_type carry = addmul_1(at_2, x + 2 * k, top, 4);
+    add(at_2 + top, at_2 + top, k + 1 - top, &carry, 1);
+  };
+  evaluate_at_2(a, a_eval);
+  evaluate_at_2(b, b_eval);
+  mul_balanced(w2, a_eval, b_eval, k + 1, next_scratch);
+
+  digit_type* r0 = r;
+  digit_type* r4 = r + 4 * k;
+  mul_balanced(r0, a, b, k, next_scratch);
+  mul_balanced(r4, a + 2 * k, b + 2 * k, top, next_scratch);
+  std::fill(r + 2 * k, r + 4 * k, 0);
+
+  // even = (w1 + wm1) / 2 = r0 + r2 + r4, odd = (w1 - wm1) / 2 = r1 + r3
+  digit_type* even = a_eval;
+  digit_type* odd = wm1;
+  if (wm1_negative) {
+    sub(even, w1, len, wm1, len);
+    add(odd, w1, len, wm1, len);
+  } else {
+    add(even, w1, len, wm1, len);
+    sub(odd, w1, len, wm1, len);
+  }
+  rshift(even, even, len, 1);
+  rshift(odd, odd, len, 1);
+
+  digit_type* r2 = even;
+  sub(r2, r2, len, r0, 2 * k);
+  sub(r2, r2, len, r4, 2 * top);
+
+  // w2 = r0 + 2 * r1 + 4 * r2 + 8 * r3 + 16 * r4 = r0 + 4 * r2 + 16 * r4 + 2 * odd + 6 * r3
+  digit_type* r3 = w2;
+  sub(r3, r3, len, r0, 2 * k);
+  submul_1(r3, r2, len, 4);
+  digit_type borrow = submul_1(r3, r4, 2 * top, 16);
+  sub(r3 + 2 * top, r3 + 2 * top, len - 2 * top, &borrow, 1);
+  submul_1(r3, odd, len, 2);
+  divide_1(r3, len, 6);
+
+  digit_type* r1 = odd;
+  sub(r1, r1, len, r3, len);
+
+  add_shifted(r, 2 * n, k, r1, len);
+  add_shifted(r, 2 * n, 2 * k, r2, len);
+  add_shifted(r, 2 * n, 3 * k, r3, len);
+}
+
+// r[0, 2n) = a[0, n) * b[0, n)
+void mul_balanced(digit_type* r, const digit_type* a, const digit_type* b, size_t n, digit_type* scratch) {
+  if (n < KARATSUBA_THRESHOLD) {
+    mul_basecase(r, a, n, b, n);
+  } else if (n < TOOM3_THRESHOLD) {
+    mul_karatsuba(r, a, b, n, scratch);
+  } else {
+    mul_toom3(r, a, b, n, scratch);
+  }
+}
+
+// r[0, an + bn) = a[0, an) * b[0, bn), an >= bn, r doesn't overlap a and b
+void mul(digit_type* r, const digit_type* a, size_t an, const digit_type* b, size_t bn, digit_type* scratch) {
+  assert(an >= bn && bn > 0);
+  if (bn < KARATSUBA_THRESHOLD) {
+    mul_basecase(r, a, an, b, bn);
+    return;
+  }
+  if (an == bn) {
+    mul_balanced(r, a, b, bn, scratch);
+    return;
+  }
+
+  // split the longer operand into bn-sized chunks
+  mul_balanced(r, a, b, bn, scratch + 2 * bn);
+  std::fill(r + 2 * bn, r + an + bn, 0);
+  for (size_t offset = bn; offset < an; offset += bn) {
+    size_t chunk = std::min(bn, an - offset);
+    mul(scratch, b, bn, a + offset, chunk, scratch + 2 * bn);
+    add_shifted(r, an + bn, offset, scratch, bn + chunk);
+  }
+}
+
+// r[0, 2n) = a[0, n)^2
+void sqr_basecase(digit_type* r, const digit_type* a, size_t n) {
+  // the products a[i] * a[j], i < j, are summed once and doubled
+  std::fill(r, r + 2 * n, 0);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    r[i + n] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+  }
+  lshift(r, r, 2 * n, 1);
+
+  double_digit_type carry = 0;
+  for (size_t i = 0; i < n; ++i) {
+    double_digit_type square = static_cast<double_digit_type>(a[i]) * a[i];
+    carry += r[2 * i] + (square & std::numeric_limits<digit_type>::max());
+    r[2 * i] = static_cast<digit_type>(carry);
+    carry >>= DIGIT_BITS;
+    carry += r[2 * i + 1] + (square >> DIGIT_BITS);
+    r[2 * i + 1] = static_cast<digit_type>(carry);
+    carry >>= DIGIT_BITS;
+  }
+}
+
+// a[0, n) < b[0, n)
+bool less(const digit_type* a, const digit_type* b, size_t n) {
+  return std::lexicographical_compare(std::make_reverse_iterator(a + n), std::make_reverse_iterator(a),
+                                      std::make_reverse_iterator(b + n), std::make_reverse_iterator(b));
+}
+
+// v[0, vn) normalized, vn >= 2, u[un - vn, un) < v
+// q[0, un - vn) = u / v, u[0, vn) = u % v
+void divrem_basecase(digit_type* q, digit_type* u, size_t un, const digit_type* v, size_t vn) {
+  assert(vn >= 2 && un >= vn);
+  constexpr double_digit_type BASE = double_digit_type{1} << DIGIT_BITS;
+  digit_type v1 = v[vn - 1];
+  digit_type v2 = v[vn - 2];
+  for (size_t j = un - vn; j-- > 0;) {
+    digit_type* w = u + j;
+    double_digit_type top = (static_cast<double_digit_type>(w[vn]) << DIGIT_BITS) | w[vn - 1];
+    double_digit_type qhat = w[vn] == v1 ? BASE - 1 : top / v1;
+    double_digit_type rhat = top - qhat * v1;
+    while (rhat < BASE && qhat * v2 > ((rhat << DIGIT_BITS) | w[vn - 2])) {
+      --qhat;
+      rhat += v1;
+    }
+
+    digit_type high = w[vn];
+    digit_type borrow = submul_1(w, v, vn, static_cast<digit_type>(qhat));
+    w[vn] = high - borrow;
+    if (high < borrow) {
+      --qhat;
+      w[vn] += add(w, w, vn, v, vn);
+    }
+    q[j] = static_cast<digit_type>(qhat);
+  }
+}
+
+constexpr size_t BURNIKEL_ZIEGLER_THRESHOLD = 64;
+
+size_t div_2n_n_scratch_size(size_t n);
+
+size_t div_unbalanced_scratch_size(size_t qn, size_t vn) {
+  if (qn < BURNIKEL_ZIEGLER_THRESHOLD) {
+    return 0;
+  }
+  size_t ln = vn - qn;
+  size_t mul_size = ln == 0 ? 0 : vn + mul_scratch_size(std::max(ln, qn), std::min(ln, qn));
+  return std::max(div_2n_n_scratch_size(qn), mul_size);
+}
+
+size_t div_2n_n_scratch_size(size_t n) {
+  if (n < BURNIKEL_ZIEGLER_THRESHOLD) {
+    return 0;
+  }
+  return std::max(div_unbalanced_scratch_size(n - n / 2, n), div_unbalanced_scratch_size(n / 2, n));
+}
+
+void div_unbalanced(digit_type* q, digit_type* u, size_t qn, const digit_type* v, size_t vn, digit_type* scratch);
+
+// v[0, n) normalized, u[n, 2n) < v
+// q[0, n) = u / v, u[0, n) = u % v, u[n, 2n) is zeroed
+void div_2n_n(digit_type* q, digit_type* u, const digit_type* v, size_t n, digit_type* scratch) {
+  if (n < BURNIKEL_ZIEGLER_THRESHOLD) {
+    divrem_basecase(q, u, 2 * n, v, n);
+    return;
+  }
+  size_t h = n / 2;
+  div_unbalanced(q + h, u + h, n - h, v, n, scratch);
+  div_unbalanced(q, u, h, v, n, scratch);
+}
+
+// v = vh * B^(vn - qn) + vl normalized, qn <= vn, u[qn, qn + vn) < v
+// q[0, qn) = u / v, u[0, vn) = u % v, u[vn, qn + vn) is zeroed
+void div_unbalanced(digit_type* q, digit_type* u, size_t qn, const digit_type* v, size_t vn, digit_type* scratch) {
+  if (qn < BURNIKEL_ZIEGLER_THRESHOLD) {
+    divrem_basecase(q, u, qn + vn, v, vn);
+    return;
+  }
+  size_t ln = vn - qn;
+  const digit_type* vh = v + ln;
+
+  // estimate q from the top 2qn limbs of u divided by vh, it exceeds the real quotient by at most 2
+  if (less(u + vn, vh, qn)) {
+    div_2n_n(q, u + ln, vh, qn, scratch);
+  } else {
+    // the top qn limbs of u equal vh, so q = B^qn - 1 and the partial remainder is u[ln, vn) + vh
+    std::fill_n(q, qn, std::numeric_limits<digit_type>::max());
+    std::fill_n(u + vn, qn, 0);
+    add(u + ln, u + ln, 2 * qn, vh, qn);
+  }
+  if (ln == 0) {
+    return;
+  }
+
+  digit_type* product = scratch;
+  if (ln >= qn) {
+    mul(product, v, ln, q, qn, scratch + vn);
+  } else {
+    mul(product, q, qn, v, ln, scratch + vn);
+  }
+  digit_type borrow = sub(u, u, qn + vn, product, vn);
+  while (borrow != 0) {
+    digit_type one = 1;
+    sub(q, q, qn, &one, 1);
+    borrow -= add(u, u, qn + vn, v, vn);
+  }
+}
+
+// v[0, vn) normalized, vn >= 2, u[un - vn, un) < v
+// q[0, un - vn) = u / v, u[0, vn) = u % v
+void divrem(digit_type* q, digit_type* u, size_t un, const digit_type* v, size_t vn) {
+  size_t qn = un - vn;
+  if (vn < BURNIKEL_ZIEGLER_THRESHOLD || qn < BURNIKEL_ZIEGLER_THRESHOLD) {
+    divrem_basecase(q, u, un, v, vn);
+    return;
+  }
+
+  // the quotient is produced in blocks of vn limbs from the top, the topmost one may be shorter
+  size_t top = qn % vn;
+  std::vector<digit_type> scratch(std::max(div_2n_n_scratch_size(vn), div_unbalanced_scratch_size(top, vn)));
+  size_t offset = qn - top;
+  if (top != 0) {
+    div_unbalanced(q + offset, u + offset, top, v, vn, scratch.data());
+  }
+  while (offset != 0) {
+    offset -= vn;
+    div_2n_n(q + offset, u + offset, v, vn, scratch.data());
+  }
+}
+} // namespace
 
 big_integer::big_integer() : _negative(false) {}
 
 big_integer::big_integer(const big_integer& other) = default;
 
+big_integer::big_integer(big_integer&& other) noexcept = default;
+
+big_integer::big_integer(const big_integer& other, size_t capacity)
+    : _data(other._data, capacity),
+      _negative(other._negative) {}
+
 big_integer::big_integer(unsigned long long val, bool negative) : _negative(negative) {
   if (val != 0) {
     _data.push_back(static_cast<digit_type>(val));
@@ -41,41 +528,36 @@ big_integer::big_integer(short val) : big_integer(static_cast<long long>(val)) {
 
 big_integer::big_integer(unsigned short val) : big_integer(static_cast<unsigned long long>(val)) {}
 
-big_integer::big_integer(const std::string& str) : big_integer() {
-  size_t index = 0;
-  if (!str.empty() && str[index] == '-') {
-    negate();
-    ++index;
+big_integer::big_integer(std::string_view str) : big_integer() {
+  bool negative = !str.empty() && str.front() == '-';
+  if (negative) {
+    str.remove_prefix(1);
   }
 
-  if (index == str.size()) {
+  if (str.empty()) {
     throw std::invalid_argument("Empty number in big_integer from string constructor");
   }
 
-  while (index != str.size()) {
-    size_t end = std::min(index + DIGITS_10, str.size());
-    digit_type digit = 0;
-    auto res = std::from_chars(&str[index], &str[end], digit);
-    if (res.ptr != &str[end]) {
-      throw std::invalid_argument("String parse error in big_integer constructor");
-    }
-    abs_mul_int(static_cast<digit_type>(std::pow(10, end - index)));
-    abs_add_int(digit);
-    index = end;
-  }
-
-  trim();
+  parse_decimal(str).swap(*this);
+  _negative = negative;
 }
 
 big_integer::~big_integer() = default;
 
 big_integer& big_integer::operator=(const big_integer& other) {
   if (&other != this) {
-    big_integer(other).swap(*this);
+    _data = other._data;
+    _negative = other._negative;
   }
   return *this;
 }
 
+big_integer& big_integer::operator=(big_integer&& other) noexcept {
+  _data = std::move(other._data);
+  _negative = other._negative;
+  return *this;
+}
+
 big_integer& big_integer::operator+=(const big_integer& rhs) {
   if (is_negative() == rhs.is_negative()) {
     abs_add(rhs, *this);
@@ -102,21 +584,36 @@ big_integer& big_integer::operator+=(const big_integer& rhs) {
 }
 
 big_integer& big_integer::operator-=(const big_integer& rhs) {
+  if (&rhs == this) {
+    _data.clear();
+    return *this;
+  }
   return (negate() += rhs).negate();
 }
 
 big_integer& big_integer::operator*=(const big_integer& rhs) {
   _negative ^= rhs.is_negative();
-  return abs_mul(rhs);
+  if (rhs._data.size() == 1 && &rhs != this) {
+    return abs_mul_int(rhs._data[0]);
+  }
+  return abs_mul(*this, rhs);
 }
 
+// the remainder is computed in the buffer of *this, only the quotient needs a new one
 big_integer& big_integer::operator/=(const big_integer& rhs) {
-  div_rem(rhs);
+  bool negative = is_negative() != rhs.is_negative();
+  big_integer quotient;
+  abs_divmod(*this, rhs, quotient, *this);
+  quotient._negative = negative;
+  swap(quotient);
   return *this;
 }
 
 big_integer& big_integer::operator%=(const big_integer& rhs) {
-  div_rem(rhs).swap(*this);
+  bool negative = is_negative();
+  big_integer quotient;
+  abs_divmod(*this, rhs, quotient, *this);
+  _negative = negative;
   return *this;
 }
 
@@ -132,38 +629,87 @@ big_integer& big_integer::operator^=(const big_integer& rhs) {
   return bitwise_operation(rhs, std::bit_xor<>());
 }
 
-big_integer& big_integer::operator<<=(int rhs) {
-  _data.insert(_data.begin(), rhs / DIGIT_BITS, 0);
-  abs_mul_int(static_cast<digit_type>(1) << (rhs % DIGIT_BITS));
-  return *this;
+size_t big_integer::popcount() const noexcept {
+  size_t res = 0;
+  for (digit_type d : _data) {
+    res += std::popcount(d);
+  }
+  return res;
 }
 
-big_integer& big_integer::operator>>=(int rhs) {
-  ptrdiff_t to_erase = rhs / DIGIT_BITS;
-  if (to_erase > _data.size()) {
-    _data.clear();
-    return *this;
+size_t big_integer::bit_length() const noexcept {
+  return _data.empty() ? 0 : (_data.size() - 1) * DIGIT_BITS + std::bit_width(_data.back());
+}
+
+bool big_integer::test_bit(size_t bit) const noexcept {
+  size_t limb = bit / DIGIT_BITS;
+  if (limb >= _data.size()) {
+    return is_negative();
+  }
+  bool value = (_data[limb] >> (bit % DIGIT_BITS)) & 1;
+  if (!is_negative()) {
+    return value;
   }
 
-  _data.erase(_data.begin(), _data.begin() + to_erase);
-  abs_divide_int(static_cast<digit_type>(1) << (rhs % DIGIT_BITS));
+  // ~(|x| - 1): the bits below the lowest set bit of |x| stay zero, that bit stays set, the ones above are inverted
+  size_t lowest = std::find_if(_data.begin(), _data.end(), [](digit_type d) { return d != 0; }) - _data.begin();
+  lowest = lowest * DIGIT_BITS + std::countr_zero(_data[lowest]);
+  return bit <= lowest ? value : !value;
+}
 
+big_integer& big_integer::set_bit(size_t bit, bool value) {
   if (is_negative()) {
-    abs_add_int(1);
+    big_integer mask;
+    mask.set_bit(bit, true);
+    return value ? *this |= mask : *this &= ~std::move(mask);
+  }
+
+  size_t limb = bit / DIGIT_BITS;
+  digit_type mask = digit_type{1} << (bit % DIGIT_BITS);
+  if (value) {
+    if (limb >= _data.size()) {
+      _data.resize(limb + 1);
+    }
+    _data[limb] |= mask;
+  } else if (limb < _data.size()) {
+    _data[limb] &= ~mask;
+    trim();
   }
   return *this;
 }
 
-big_integer big_integer::operator+() const {
+big_integer& big_integer::operator<<=(int rhs) {
+  assert(rhs >= 0);
+  return shift_left(*this, rhs);
+}
+
+big_integer& big_integer::operator>>=(int rhs) {
+  assert(rhs >= 0);
+  return shift_right(*this, rhs);
+}
+
+big_integer big_integer::operator+() const& {
   return *this;
 }
 
-big_integer big_integer::operator-() const {
-  return big_integer(*this).negate();
+big_integer big_integer::operator+() && {
+  return std::move(*this);
+}
+
+big_integer big_integer::operator-() const& {
+  return -big_integer(*this);
+}
+
+big_integer big_integer::operator-() && {
+  return std::move(negate());
 }
 
-big_integer big_integer::operator~() const {
-  return --big_integer(*this).negate();
+big_integer big_integer::operator~() const& {
+  return ~big_integer(*this);
+}
+
+big_integer big_integer::operator~() && {
+  return std::move(--negate());
 }
 
 big_integer& big_integer::operator++() {
@@ -196,43 +742,151 @@ big_integer big_integer::operator--(int) {
 }
 
 big_integer operator+(const big_integer& a, const big_integer& b) {
-  return big_integer(a) += b;
+  big_integer res(a, std::max(a._data.size(), b._data.size()) + 1);
+  res += b;
+  return res;
+}
+
+big_integer operator+(big_integer&& a, const big_integer& b) {
+  return std::move(a += b);
+}
+
+big_integer operator+(const big_integer& a, big_integer&& b) {
+  return std::move(b += a);
+}
+
+big_integer operator+(big_integer&& a, big_integer&& b) {
+  return std::move(a += b);
 }
 
 big_integer operator-(const big_integer& a, const big_integer& b) {
-  return big_integer(a) -= b;
+  big_integer res(a, std::max(a._data.size(), b._data.size()) + 1);
+  res -= b;
+  return res;
+}
+
+big_integer operator-(big_integer&& a, const big_integer& b) {
+  return std::move(a -= b);
+}
+
+big_integer operator-(const big_integer& a, big_integer&& b) {
+  return std::move((b -= a).negate());
+}
+
+big_integer operator-(big_integer&& a, big_integer&& b) {
+  return std::move(a -= b);
 }
 
 big_integer operator*(const big_integer& a, const big_integer& b) {
-  return big_integer(a) *= b;
+  big_integer res;
+  res.abs_mul(a, b);
+  res._negative = a.is_negative() ^ b.is_negative();
+  return res;
+}
+
+// the product can't overlap its operands, so an rvalue is reused only when the other operand is a single limb
+big_integer operator*(big_integer&& a, const big_integer& b) {
+  return std::move(a *= b);
+}
+
+big_integer operator*(const big_integer& a, big_integer&& b) {
+  return std::move(b *= a);
+}
+
+big_integer operator*(big_integer&& a, big_integer&& b) {
+  return a._data.size() == 1 ? std::move(b *= a) : std::move(a *= b);
 }
 
 big_integer operator/(const big_integer& a, const big_integer& b) {
-  return big_integer(a) /= b;
+  return divmod(a, b).first;
+}
+
+big_integer operator/(big_integer&& a, const big_integer& b) {
+  return std::move(a /= b);
 }
 
 big_integer operator%(const big_integer& a, const big_integer& b) {
-  return big_integer(a) %= b;
+  return divmod(a, b).second;
+}
+
+big_integer operator%(big_integer&& a, const big_integer& b) {
+  return std::move(a %= b);
 }
 
 big_integer operator&(const big_integer& a, const big_integer& b) {
-  return big_integer(a) &= b;
+  big_integer res(a, big_integer::bitwise_capacity(a, b));
+  res &= b;
+  return res;
+}
+
+big_integer operator&(big_integer&& a, const big_integer& b) {
+  return std::move(a &= b);
+}
+
+big_integer operator&(const big_integer& a, big_integer&& b) {
+  return std::move(b &= a);
+}
+
+big_integer operator&(big_integer&& a, big_integer&& b) {
+  return std::move(a &= b);
 }
 
 big_integer operator|(const big_integer& a, const big_integer& b) {
-  return big_integer(a) |= b;
+  big_integer res(a, big_integer::bitwise_capacity(a, b));
+  res |= b;
+  return res;
+}
+
+big_integer operator|(big_integer&& a, const big_integer& b) {
+  return std::move(a |= b);
+}
+
+big_integer operator|(const big_integer& a, big_integer&& b) {
+  return std::move(b |= a);
+}
+
+big_integer operator|(big_integer&& a, big_integer&& b) {
+  return std::move(a |= b);
 }
 
 big_integer operator^(const big_integer& a, const big_integer& b) {
-  return big_integer(a) ^= b;
+  big_integer res(a, big_integer::bitwise_capacity(a, b));
+  res ^= b;
+  return res;
+}
+
+big_integer operator^(big_integer&& a, const big_integer& b) {
+  return std::move(a ^= b);
+}
+
+big_integer operator^(const big_integer& a, big_integer&& b) {
+  return std::move(b ^= a);
+}
+
+big_integer operator^(big_integer&& a, big_integer&& b) {
+  return std::move(a ^= b);
 }
 
 big_integer operator<<(const big_integer& a, int b) {
-  return big_integer(a) <<= b;
+  assert(b >= 0);
+  big_integer res;
+  res.shift_left(a, b);
+  return res;
+}
+
+big_integer operator<<(big_integer&& a, int b) {
+  return std::move(a <<= b);
 }
 
 big_integer operator>>(const big_integer& a, int b) {
-  return big_integer(a) >>= b;
+  assert(b >= 0);
+  big_integer res;
+  res.shift_right(a, b);
+  return res;
+}
+
+big_integer operator>>(big_integer&& a, int b) {
+  return std::move(a >>= b);
 }
 
 bool operator==(const big_integer& a, const big_integer& b) {
@@ -274,32 +928,43 @@ bool operator>=(const big_integer& a, const big_integer& b) {
   return operator<=(b, a);
 }
 
-std::string to_string(const big_integer& a) {
+size_t to_chars_max_length(const big_integer& a) noexcept {
+  // log10(2) < 0.30103, plus one char for the sign
+  return a._data.size() * big_integer::DIGIT_BITS * 30103 / 100000 + 2;
+}
+
+std::to_chars_result to_chars(char* first, char* last, const big_integer& a) {
   if (a.is_zero()) {
-    return "0";
+    return std::to_chars(first, last, 0);
   }
 
-  big_integer copy = a;
-  std::string res;
-
-  while (!copy.is_zero()) {
-    auto rem = copy.abs_divide_int(big_integer::DIGIT_MOD10);
-    size_t len = 9;
-    while (rem != 0) {
-      res.push_back(rem % 10 + '0');
-      rem /= 10;
-      --len;
-    }
-    if (!copy.is_zero()) {
-      res.insert(res.end(), len, '0');
+  if (a.is_negative()) {
+    if (first == last) {
+      return {last, std::errc::value_too_large};
     }
+    *first++ = '-';
   }
 
-  if (a.is_negative()) {
-    res.push_back('-');
+  size_t bits = a._data.size() * big_integer::DIGIT_BITS;
+  size_t k = 0;
+  while ((big_integer::DIGIT_MOD10_MIN_BITS << (k + 1)) < bits) {
+    ++k;
+  }
+
+  big_integer abs = a;
+  abs._negative = false;
+  char* end = big_integer::write_decimal(abs, k, false, first, last);
+  if (end == nullptr) {
+    return {last, std::errc::value_too_large};
   }
+  return {end, std::errc()};
+}
 
-  std::reverse(res.begin(), res.end());
+std::string to_string(const big_integer& a) {
+  std::string res(to_chars_max_length(a), '\0');
+  [[maybe_unused]] auto [end, ec] = to_chars(res.data(), res.data() + res.size(), a);
+  assert(ec == std::errc());
+  res.resize(end - res.data());
   return res;
 }
 
@@ -311,8 +976,8 @@ bool big_integer::is_negative() const noexcept {
   return _negative && !is_zero();
 }
 
-void big_integer::swap(big_integer& other) noexcept(std::is_nothrow_swappable_v<std::vector<digit_type>>) {
-  std::swap(_data, other._data);
+void big_integer::swap(big_integer& other) noexcept {
+  _data.swap(other._data);
   std::swap(_negative, other._negative);
 }
 
@@ -361,53 +1026,96 @@ void big_integer::abs_subtract(const big_integer& rhs, big_integer& output, size
   assert(this == &output || &rhs == &output);
 
   output._negative = is_negative();
-  double_digit_type borrow = 0;
+  size_t size = std::min(max_size, _data.size());
+  output._data.resize(size);
+  [[maybe_unused]] digit_type borrow =
+      sub(output._data.data(), _data.data(), size, rhs._data.data(), std::min(size, rhs._data.size()));
+  assert(borrow == 0);
+  output.trim();
+}
 
-  size_t i = 0;
-  size_t size = std::min(max_size, rhs._data.size());
-  for (; i < size; i++) {
-    double_digit_type diff = static_cast<double_digit_type>(_data[i]) - rhs._data[i] - borrow;
-    borrow = diff > DIGIT_MAX_VALUE;
-    output._data[i] = static_cast<digit_type>(diff);
-  }
+size_t big_integer::bitwise_capacity(const big_integer& a, const big_integer& b) noexcept {
+  return std::max(a._data.size(), b._data.size()) + (a.is_negative() || b.is_negative());
+}
 
-  size = std::min(max_size, _data.size());
-  for (; i < size && borrow; i++) {
-    double_digit_type diff = static_cast<double_digit_type>(_data[i]) - borrow;
-    borrow = diff > DIGIT_MAX_VALUE;
-    output._data[i] = static_cast<digit_type>(diff);
+template <class BitwiseOperation>
+big_integer& big_integer::bitwise_operation(const big_integer& rhs, BitwiseOperation op) {
+  constexpr bool is_and = std::is_same_v<BitwiseOperation, std::bit_and<>>;
+  bool a_negative = is_negative();
+  bool b_negative = rhs.is_negative();
+  size_t an = _data.size();
+  size_t bn = rhs._data.size();
+
+  if (!a_negative && !b_negative) {
+    size_t common = std::min(an, bn);
+    if (is_and || an < bn) {
+      _data.resize(is_and ? common : bn);
+    }
+    digit_type* r = _data.data();
+    const digit_type* b = rhs._data.data();
+    for (size_t i = 0; i < common; ++i) {
+      r[i] = op(r[i], b[i]);
+    }
+    if constexpr (!is_and) {
+      std::copy(b + common, b + bn, r + common);
+    }
+    _negative = false;
+    trim();
+    return *this;
   }
-  output.trim();
-}
 
-big_integer::digit_type big_integer::twos_complement(bool neg, big_integer::digit_type digit,
-                                                     big_integer::digit_type& carry) {
-  if (!neg) {
-    return digit;
+  // a negative x is ~(|x| - 1) in two's complement, so each operand needs a borrow chain that stops at its lowest
+  // set bit, and a negative result needs a carry chain to recover the magnitude; a negative result may take a limb
+  // more than the operands, and for & the non-negative operand bounds the result
+  bool result_negative = op(a_negative, b_negative);
+  size_t size = std::max(an, bn) + 1;
+  if constexpr (is_and) {
+    size = !a_negative ? an : !b_negative ? bn : size;
+  }
+  _data.resize(size);
+
+  digit_type a_mask = 0 - static_cast<digit_type>(a_negative);
+  digit_type b_mask = 0 - static_cast<digit_type>(b_negative);
+  digit_type r_mask = 0 - static_cast<digit_type>(result_negative);
+  digit_type a_borrow = a_negative;
+  digit_type b_borrow = b_negative;
+  digit_type r_carry = result_negative;
+  digit_type* r = _data.data();
+  const digit_type* b = rhs._data.data();
+  for (size_t i = 0; i < size; ++i) {
+    digit_type x = r[i];
+    digit_type y = i < bn ? b[i] : 0;
+    digit_type a_digit = (x - a_borrow) ^ a_mask;
+    digit_type b_digit = (y - b_borrow) ^ b_mask;
+    a_borrow &= x == 0;
+    b_borrow &= y == 0;
+    digit_type res = (op(a_digit, b_digit) ^ r_mask) + r_carry;
+    r_carry &= res == 0;
+    r[i] = res;
   }
-  double_digit_type res = carry;
-  res += ~digit;
-  carry = static_cast<digit_type>(res >> DIGIT_BITS);
-  return static_cast<digit_type>(res);
-}
 
-big_integer& big_integer::abs_mul(const big_integer& rhs) {
-  size_t this_size = _data.size();
-  size_t rhs_size = rhs._data.size();
+  _negative = result_negative;
+  trim();
+  return *this;
+}
 
-  _data.insert(_data.begin(), rhs_size, 0);
+big_integer& big_integer::abs_mul(const big_integer& a, const big_integer& b) {
+  if (a.is_zero() || b.is_zero()) {
+    _data.clear();
+    return *this;
+  }
 
-  for (size_t i = 0; i < this_size; ++i) {
-    digit_type carry = 0;
-    double_digit_type data_i = _data[i + rhs_size];
-    for (size_t j = 0; j < rhs_size; ++j) {
-      double_digit_type res = data_i * rhs._data[j] + _data[i + j] + carry;
-      carry = static_cast<digit_type>(res >> DIGIT_BITS);
-      _data[i + j] = static_cast<digit_type>(res);
-    }
-    _data[i + rhs_size] = carry;
+  const digit_vector* longer = &a._data;
+  const digit_vector* shorter = &b._data;
+  if (longer->size() < shorter->size()) {
+    std::swap(longer, shorter);
   }
 
+  digit_vector result(longer->size() + shorter->size());
+  digit_type* scratch = mul_scratch(longer->size(), shorter->size());
+  mul(result.data(), longer->data(), longer->size(), shorter->data(), shorter->size(), scratch);
+
+  _data.swap(result);
   trim();
   return *this;
 }
@@ -461,71 +1169,388 @@ big_integer& big_integer::abs_mul_int(digit_type rhs) {
   return *this;
 }
 
-int32_t big_integer::normalize() {
-  if (_data.back() >= DIGIT_BASE / 2) {
-    return 0;
+const big_integer& big_integer::decimal_power(size_t k) {
+  static_assert((static_cast<digit_type>(1) << DIGIT_MOD10_MIN_BITS) <= DIGIT_MOD10);
+  thread_local std::deque<big_integer> powers{DIGIT_MOD10};
+  while (powers.size() <= k) {
+    powers.push_back(powers.back() * powers.back());
+  }
+  return powers[k];
+}
+
+big_integer big_integer::parse_decimal(std::string_view digits) {
+  if (digits.size() > PARSE_BASE_DIGITS) {
+    size_t k = 0;
+    while ((DIGITS_10 << (k + 1)) < digits.size()) {
+      ++k;
+    }
+    size_t low_size = DIGITS_10 << k;
+    big_integer res = parse_decimal(digits.substr(0, digits.size() - low_size));
+    res *= decimal_power(k);
+    res += parse_decimal(digits.substr(digits.size() - low_size));
+    return res;
+  }
+
+  static constexpr std::array<digit_type, DIGITS_10 + 1> POWERS_10 = [] {
+    std::array<digit_type, DIGITS_10 + 1> res{1};
+    for (size_t i = 1; i < res.size(); ++i) {
+      res[i] = res[i - 1] * 10;
+    }
+    return res;
+  }();
+
+  big_integer res;
+  for (size_t index = 0; index != digits.size();) {
+    size_t end = std::min(index + DIGITS_10, digits.size());
+    digit_type digit = 0;
+    auto [ptr, ec] = std::from_chars(digits.data() + index, digits.data() + end, digit);
+    if (ec != std::errc() || ptr != digits.data() + end) {
+      throw std::invalid_argument("String parse error in big_integer constructor");
+    }
+    res.abs_mul_int(POWERS_10[end - index]);
+    res.abs_add_int(digit);
+    index = end;
+  }
+  res.trim();
+  return res;
+}
+
+char* big_integer::write_decimal(big_integer x, size_t k, bool pad, char* first, char* last) {
+  if (k > TO_STRING_BASE_LEVEL) {
+    auto [high, low] = divmod(x, decimal_power(k));
+    if (pad || !high.is_zero()) {
+      first = write_decimal(std::move(high), k - 1, pad, first, last);
+      if (first == nullptr) {
+        return nullptr;
+      }
+      pad = true;
+    }
+    return write_decimal(std::move(low), k - 1, pad, first, last);
+  }
+
+  std::array<digit_type, (2 << TO_STRING_BASE_LEVEL)> chunks{};
+  size_t count = 0;
+  while (!x.is_zero()) {
+    chunks[count++] = x.abs_divide_int(DIGIT_MOD10);
+  }
+  if (pad) {
+    count = 2 << k;
+  } else {
+    auto [ptr, ec] = std::to_chars(first, last, chunks[count - 1]);
+    if (ec != std::errc()) {
+      return nullptr;
+    }
+    first = ptr;
+    --count;
+  }
+
+  if (static_cast<size_t>(last - first) < count * DIGITS_10) {
+    return nullptr;
+  }
+  for (size_t i = count; i-- > 0;) {
+    digit_type chunk = chunks[i];
+    for (size_t j = DIGITS_10; j-- > 0;) {
+      first[j] = static_cast<char>('0' + chunk % 10);
+      chunk /= 10;
+    }
+    first += DIGITS_10;
+  }
+  return first;
+}
+
+big_integer& big_integer::shift_left(const big_integer& a, size_t shift) {
+  if (a.is_zero()) {
+    _data.clear();
+    return *this;
+  }
+
+  size_t limbs = shift / DIGIT_BITS;
+  size_t size = a._data.size();
+  if (this != &a) {
+    _data.clear();
+  }
+  _data.resize(size + limbs + 1);
+
+  const digit_type* src = this == &a ? _data.data() : a._data.data();
+  _data[size + limbs] = lshift(_data.data() + limbs, src, size, shift % DIGIT_BITS);
+  std::fill_n(_data.data(), limbs, 0);
+  _negative = a._negative;
+  trim();
+  return *this;
+}
+
+big_integer& big_integer::shift_right(const big_integer& a, size_t shift) {
+  size_t limbs = shift / DIGIT_BITS;
+  bool negative = a.is_negative();
+  if (limbs >= a._data.size()) {
+    _data.clear();
+    if (negative) {
+      _data.push_back(1);
+    }
+    _negative = negative;
+    return *this;
   }
-  auto k = static_cast<int32_t>(std::log2(DIGIT_BASE / 2) - std::log2(_data.back()));
-  if ((_data.back() << k) < DIGIT_BASE / 2) {
-    k++;
+
+  // rounding towards negative infinity: the magnitude is incremented if any set bit is shifted out
+  bool inexact = negative && std::any_of(a._data.begin(), a._data.begin() + limbs, [](digit_type d) { return d != 0; });
+  size_t size = a._data.size() - limbs;
+  if (this != &a) {
+    _data.clear();
+    _data.resize(size);
+  }
+  inexact |= rshift(_data.data(), a._data.data() + limbs, size, shift % DIGIT_BITS) != 0 && negative;
+  _data.resize(size);
+  _negative = negative;
+  trim();
+  if (inexact) {
+    abs_add_int(1);
   }
-  *this <<= k;
-  return k;
+  return *this;
 }
 
-big_integer big_integer::div_rem(big_integer rhs) {
-  if (rhs.is_zero()) {
+void big_integer::abs_divmod(const big_integer& a, const big_integer& b, big_integer& quotient,
+                             big_integer& remainder) {
+  if (b.is_zero()) {
     throw std::invalid_argument("big_integer division by zero");
   }
 
-  big_integer rem;
+  size_t un = a._data.size();
+  size_t vn = b._data.size();
+  quotient._data.clear();
+  quotient._negative = false;
+  remainder._negative = false;
+  if (un < vn || (un == vn && std::lexicographical_compare(a._data.rbegin(), a._data.rend(), b._data.rbegin(),
+                                                           b._data.rend()))) {
+    if (&remainder != &a) {
+      remainder._data = a._data;
+    }
+    return;
+  }
+
+  if (vn == 1) {
+    quotient._data = a._data;
+    digit_type rem = divide_1(quotient._data.data(), un, b._data[0]);
+    quotient.trim();
+    remainder._data.clear();
+    if (rem != 0) {
+      remainder._data.push_back(rem);
+    }
+    return;
+  }
+
+  size_t shift = std::countl_zero(b._data.back());
+  digit_vector v(vn);
+  lshift(v.data(), b._data.data(), vn, shift);
+  if (&remainder != &a) {
+    remainder._data.clear();
+  }
+  remainder._data.resize(un + 1);
+  const digit_type* src = &remainder == &a ? remainder._data.data() : a._data.data();
+  remainder._data[un] = lshift(remainder._data.data(), src, un, shift);
+  quotient._data.resize(un + 1 - vn);
+
+  divrem(quotient._data.data(), remainder._data.data(), un + 1, v.data(), vn);
+  rshift(remainder._data.data(), remainder._data.data(), vn, shift);
+  remainder._data.resize(vn);
+  quotient.trim();
+  remainder.trim();
+}
+
+std::pair<big_integer, big_integer> divmod(const big_integer& a, const big_integer& b) {
+  std::pair<big_integer, big_integer> res;
+  big_integer::abs_divmod(a, b, res.first, res.second);
+  res.first._negative = a.is_negative() != b.is_negative();
+  res.second._negative = a.is_negative();
+  return res;
+}
+
+big_integer pow_mod(const big_integer& base, const big_integer& exp, const big_integer& mod) {
+  if (mod.is_negative() || mod.is_zero()) {
+    throw std::invalid_argument("pow_mod modulus must be positive");
+  }
+  if (exp.is_negative()) {
+    throw std::invalid_argument("pow_mod exponent must be non-negative");
+  }
+  if (mod == 1) {
+    return 0;
+  }
+  if (mod._data[0] % 2 != 0) {
+    montgomery_context context(mod);
+    return context.from_montgomery(context.exp(context.to_montgomery(base), exp));
+  }
+
+  big_integer b = base % mod;
+  if (b.is_negative()) {
+    b += mod;
+  }
+  big_integer res = 1;
+  for (size_t i = exp._data.size() * DIGIT_BITS; i-- > 0;) {
+    res = res * res % mod;
+    if ((exp._data[i / DIGIT_BITS] >> (i % DIGIT_BITS)) & 1) {
+      res = res * b % mod;
+    }
+  }
+  return res;
+}
+
+montgomery_context::montgomery_context(const big_integer& mod) : _mod(mod), _size(mod._data.size()) {
+  if (mod.is_negative() || mod.is_zero() || mod._data[0] % 2 == 0 || mod == 1) {
+    throw std::invalid_argument("montgomery_context modulus must be odd and greater than one");
+  }
 
-  if (is_zero() || _data.size() < rhs._data.size()) {
-    rem.swap(*this);
-    return rem;
+  // Newton's iteration for m^-1 mod B, each step doubles the number of correct low bits starting from 3
+  digit_type m0 = mod._data[0];
+  digit_type inv = m0;
+  for (size_t bits = 3; bits < DIGIT_BITS; bits *= 2) {
+    inv *= 2 - m0 * inv;
   }
+  _inv = 0 - inv;
+  _r2 = (big_integer(1) << static_cast<int>(2 * _size * DIGIT_BITS)) % mod;
+}
+
+const big_integer& montgomery_context::modulus() const noexcept {
+  return _mod;
+}
 
-  bool this_sign = is_negative();
-  bool result_sign = is_negative() ^ rhs.is_negative();
+big_integer montgomery_context::to_montgomery(const big_integer& a) const {
+  big_integer x = a % _mod;
+  if (x.is_negative()) {
+    x += _mod;
+  }
+  return mul(x, _r2);
+}
 
-  _negative = false;
-  rhs._negative = false;
+big_integer montgomery_context::from_montgomery(const big_integer& a) const {
+  std::vector<digit_type> workspace(3 * _size);
+  digit_type* r = workspace.data();
+  digit_type* t = r + _size;
+  load(t, a);
+  reduce(r, t);
+  return store(r);
+}
 
-  int32_t k = rhs.normalize();
-  *this <<= k;
+big_integer montgomery_context::mul(const big_integer& a, const big_integer& b) const {
+  std::vector<digit_type> workspace(2 * _size + scratch_size());
+  digit_type* x = workspace.data();
+  digit_type* y = x + _size;
+  load(x, a);
+  load(y, b);
+  mul(x, x, y, y + _size);
+  return store(x);
+}
 
-  size_t m = _data.size() - rhs._data.size();
+big_integer montgomery_context::sqr(const big_integer& a) const {
+  std::vector<digit_type> workspace(_size + scratch_size());
+  digit_type* x = workspace.data();
+  load(x, a);
+  sqr(x, x, x + _size);
+  return store(x);
+}
 
-  std::vector<digit_type> q(m + 1, 0);
-  auto q_it = q.rbegin();
-  rhs._data.insert(rhs._data.begin(), m, 0);
+big_integer montgomery_context::exp(const big_integer& a, const big_integer& e) const {
+  if (e.is_negative()) {
+    throw std::invalid_argument("montgomery_context exponent must be non-negative");
+  }
+  if (e.is_zero()) {
+    return to_montgomery(1);
+  }
 
-  if (*this >= rhs) {
-    *q_it = 1;
-    this->abs_subtract(rhs, *this);
+  // sliding window over the exponent bits with a table of odd powers a^1, a^3, ..., a^(2^window - 1)
+  size_t n = _size;
+  size_t bits = (e._data.size() - 1) * DIGIT_BITS + std::bit_width(e._data.back());
+  size_t window = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : bits > 6 ? 2 : 1;
+  size_t table_size = size_t{1} << (window - 1);
+
+  std::vector<digit_type> workspace((table_size + 2) * n + scratch_size());
+  digit_type* table = workspace.data();
+  digit_type* square = table + table_size * n;
+  digit_type* res = square + n;
+  digit_type* scratch = res + n;
+
+  load(table, a);
+  if (table_size > 1) {
+    sqr(square, table, scratch);
+    for (size_t k = 1; k < table_size; ++k) {
+      mul(table + k * n, table + (k - 1) * n, square, scratch);
+    }
   }
-  ++q_it;
 
-  for (; q_it != q.rend() && _data.size() >= 2; ++q_it) {
-    rhs._data.erase(rhs._data.begin());
-    double_digit_type t =
-        ((static_cast<double_digit_type>(_data.back()) << DIGIT_BITS) | _data[_data.size() - 2]) / rhs._data.back();
-    *q_it = std::min(t, DIGIT_BASE - 1);
-    *this -= *q_it * rhs;
-    while (*this < 0) {
-      --*q_it;
-      *this += rhs;
+  auto bit = [&e](size_t i) -> digit_type { return (e._data[i / DIGIT_BITS] >> (i % DIGIT_BITS)) & 1; };
+  bool started = false;
+  for (size_t i = bits; i > 0;) {
+    if (!bit(i - 1)) {
+      sqr(res, res, scratch);
+      --i;
+      continue;
+    }
+
+    // the longest run e[j, i) of at most window bits ending with a set bit
+    size_t j = i > window ? i - window : 0;
+    while (!bit(j)) {
+      ++j;
+    }
+    size_t value = 0;
+    for (size_t k = i; k-- > j;) {
+      value = (value << 1) | bit(k);
+    }
+
+    const digit_type* power = table + (value >> 1) * n;
+    if (started) {
+      for (size_t k = j; k < i; ++k) {
+        sqr(res, res, scratch);
+      }
+      mul(res, res, power, scratch);
+    } else {
+      std::copy_n(power, n, res);
+      started = true;
     }
+    i = j;
   }
+  return store(res);
+}
 
-  std::swap(rem._data, _data);
-  rem.trim();
-  rem.abs_divide_int(static_cast<digit_type>(1) << k);
-  rem._negative = this_sign;
+void montgomery_context::mul(digit_type* r, const digit_type* a, const digit_type* b, digit_type* scratch) const {
+  digit_type* t = scratch;
+  ::mul(t, a, _size, b, _size, scratch + 2 * _size);
+  reduce(r, t);
+}
 
-  std::swap(_data, q);
-  _negative = result_sign;
-  trim();
+void montgomery_context::sqr(digit_type* r, const digit_type* a, digit_type* scratch) const {
+  digit_type* t = scratch;
+  if (_size < SQR_KARATSUBA_THRESHOLD) {
+    sqr_basecase(t, a, _size);
+  } else {
+    ::mul(t, a, _size, a, _size, scratch + 2 * _size);
+  }
+  reduce(r, t);
+}
+
+void montgomery_context::reduce(digit_type* r, digit_type* t) const {
+  // t[i] is zeroed by step i, so the carry out of step i, which belongs at t[i + n], is parked there
+  size_t n = _size;
+  const digit_type* m = _mod._data.data();
+  for (size_t i = 0; i < n; ++i) {
+    t[i] = addmul_1(t + i, m, n, t[i] * _inv);
+  }
+  digit_type carry = add(r, t + n, n, t, n);
+  if (carry != 0 || !less(r, m, n)) {
+    sub(r, r, n, m, n);
+  }
+}
+
+size_t montgomery_context::scratch_size() const noexcept {
+  return 2 * _size + mul_scratch_size(_size, _size);
+}
 
-  return rem;
+void montgomery_context::load(digit_type* r, const big_integer& a) const {
+  assert(!a.is_negative() && a < _mod && "residue is not reduced modulo m");
+  std::fill(std::copy(a._data.begin(), a._data.end(), r), r + _size, 0);
+}
+
+big_integer montgomery_context::store(const digit_type* a) const {
+  big_integer res;
+  res._data.resize(_size);
+  std::copy_n(a, _size, res._data.data());
+  res.trim();
+  return res;
 }
@@ -1,12 +1,258 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <charconv>
 #include <cmath>
 #include <compare>
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
+#include <iterator>
 #include <limits>
 #include <string>
-#include <vector>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace big_integer_impl {
+// vector of trivially copyable values, the first SMALL_SIZE of which are stored inline
+template <typename T, size_t SMALL_SIZE>
+class small_vector {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  using value_type = T;
+
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  union storage {
+    T* dynamic_data;
+    T small_data[SMALL_SIZE];
+  };
+
+  storage _storage;
+  size_t _size;
+  size_t _capacity;
+
+  bool is_small() const noexcept {
+    return _capacity == SMALL_SIZE;
+  }
+
+  void set_capacity(size_t new_capacity) {
+    assert(new_capacity >= size());
+    if (new_capacity <= SMALL_SIZE) {
+      if (!is_small()) {
+        T* old_data = _storage.dynamic_data;
+        std::copy_n(old_data, size(), _storage.small_data);
+        _capacity = SMALL_SIZE;
+        delete[] old_data;
+      }
+      return;
+    }
+
+    T* new_data = new T[new_capacity];
+    std::copy_n(data(), size(), new_data);
+    if (!is_small()) {
+      delete[] _storage.dynamic_data;
+    }
+    _storage.dynamic_data = new_data;
+    _capacity = new_capacity;
+  }
+
+  void grow(size_t min_capacity) {
+    if (min_capacity > capacity()) {
+      set_capacity(std::max(min_capacity, 2 * capacity()));
+    }
+  }
+
+public:
+  small_vector() noexcept : _size(0), _capacity(SMALL_SIZE) {}
+
+  explicit small_vector(size_t size, T value = T()) : small_vector() {
+    resize(size, value);
+  }
+
+  small_vector(const small_vector& other) : small_vector(other, other.size()) {}
+
+  small_vector(const small_vector& other, size_t capacity) : small_vector() {
+    set_capacity(std::max(capacity, other.size()));
+    std::copy_n(other.data(), other.size(), data());
+    _size = other.size();
+  }
+
+  small_vector(small_vector&& other) noexcept
+      : _storage(other._storage),
+        _size(other._size),
+        _capacity(other._capacity) {
+    other._size = 0;
+    other._capacity = SMALL_SIZE;
+  }
+
+  small_vector& operator=(const small_vector& other) {
+    if (&other != this) {
+      if (other.size() > capacity()) {
+        small_vector(other).swap(*this);
+      } else {
+        std::copy_n(other.data(), other.size(), data());
+        _size = other.size();
+      }
+    }
+    return *this;
+  }
+
+  small_vector& operator=(small_vector&& other) noexcept {
+    if (&other != this) {
+      small_vector(std::move(other)).swap(*this);
+    }
+    return *this;
+  }
+
+  ~small_vector() noexcept {
+    if (!is_small()) {
+      delete[] _storage.dynamic_data;
+    }
+  }
+
+  T* data() noexcept {
+    return is_small() ? _storage.small_data : _storage.dynamic_data;
+  }
+
+  const T* data() const noexcept {
+    return is_small() ? _storage.small_data : _storage.dynamic_data;
+  }
+
+  size_t size() const noexcept {
+    return _size;
+  }
+
+  size_t capacity() const noexcept {
+    return _capacity;
+  }
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  T& operator[](size_t index) noexcept {
+    assert(index < size() && "Out of range in subscript operator");
+    return data()[index];
+  }
+
+  const T& operator[](size_t index) const noexcept {
+    assert(index < size() && "Out of range in subscript operator");
+    return data()[index];
+  }
+
+  T& back() noexcept {
+    assert(!empty() && "Getting back element from empty vector");
+    return data()[size() - 1];
+  }
+
+  const T& back() const noexcept {
+    assert(!empty() && "Getting back element from empty vector");
+    return data()[size() - 1];
+  }
+
+  iterator begin() noexcept {
+    return data();
+  }
+
+  iterator end() noexcept {
+    return data() + size();
+  }
+
+  const_iterator begin() const noexcept {
+    return data();
+  }
+
+  const_iterator end() const noexcept {
+    return data() + size();
+  }
+
+  reverse_iterator rbegin() noexcept {
+    return reverse_iterator(end());
+  }
+
+  reverse_iterator rend() noexcept {
+    return reverse_iterator(begin());
+  }
+
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  void reserve(size_t new_capacity) {
+    if (new_capacity > capacity()) {
+      set_capacity(new_capacity);
+    }
+  }
+
+  void push_back(T value) {
+    grow(size() + 1);
+    data()[_size++] = value;
+  }
+
+  void pop_back() noexcept {
+    assert(!empty() && "vector::pop_back() on empty vector");
+    --_size;
+  }
+
+  void resize(size_t new_size, T value = T()) {
+    grow(new_size);
+    if (new_size > size()) {
+      std::fill(end(), data() + new_size, value);
+    }
+    _size = new_size;
+  }
+
+  void clear() noexcept {
+    _size = 0;
+  }
+
+  iterator insert(const_iterator pos, size_t count, T value) {
+    size_t index = pos - begin();
+    assert(index <= size() && "Index out of range in vector::insert()");
+    grow(size() + count);
+    std::copy_backward(begin() + index, end(), end() + count);
+    std::fill_n(begin() + index, count, value);
+    _size += count;
+    return begin() + index;
+  }
+
+  iterator erase(const_iterator pos) noexcept {
+    return erase(pos, pos + 1);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) noexcept {
+    size_t index = first - begin();
+    size_t last_index = last - begin();
+    assert(index <= last_index && last_index <= size() && "Index out of range in vector::erase()");
+    std::copy(begin() + last_index, end(), begin() + index);
+    _size -= last_index - index;
+    return begin() + index;
+  }
+
+  void swap(small_vector& other) noexcept {
+    std::swap(_storage, other._storage);
+    std::swap(_size, other._size);
+    std::swap(_capacity, other._capacity);
+  }
+
+  friend bool operator==(const small_vector& a, const small_vector& b) noexcept {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+  }
+};
+} // namespace big_integer_impl
 
 struct big_integer {
 private:
@@ -17,9 +263,15 @@ private:
   static constexpr double_digit_type DIGIT_BASE = static_cast<double_digit_type>(DIGIT_MAX_VALUE) + 1;
   static constexpr size_t DIGITS_10 = static_cast<size_t>(std::numeric_limits<big_integer::digit_type>::digits10);
   static constexpr digit_type DIGIT_MOD10 = 1'000'000'000;
+  static constexpr size_t DIGIT_MOD10_MIN_BITS = 29;
+  static constexpr size_t PARSE_BASE_DIGITS = 32 * DIGITS_10;
+  static constexpr size_t TO_STRING_BASE_LEVEL = 4;
+  static constexpr size_t SMALL_SIZE = 4;
+
+  using digit_vector = big_integer_impl::small_vector<digit_type, SMALL_SIZE>;
 
 private:
-  std::vector<digit_type> _data;
+  digit_vector _data;
   bool _negative;
 
 private:
@@ -30,32 +282,21 @@ private:
   void abs_subtract(const big_integer& rhs, big_integer& output,
                     size_t max_size = std::numeric_limits<size_t>::max()) const;
 
-  static digit_type twos_complement(bool neg, digit_type digit, digit_type& carry);
+  // limbs of a & b, a | b and a ^ b, with the one a negative result may take over the operands
+  static size_t bitwise_capacity(const big_integer& a, const big_integer& b) noexcept;
 
   template <class BitwiseOperation>
-  big_integer& bitwise_operation(const big_integer& rhs, BitwiseOperation op) {
-    bool result_negative = op(is_negative(), rhs.is_negative());
-    _data.resize(std::max(_data.size(), rhs._data.size()), 0);
-    digit_type a_carry = 1, b_carry = 1, res_carry = 1;
-
-    for (size_t i = 0; i < _data.size(); ++i) {
-      digit_type a_digit = twos_complement(is_negative(), _data[i], a_carry);
-      digit_type b_digit = i < rhs._data.size() ? rhs._data[i] : 0;
-      b_digit = twos_complement(rhs.is_negative(), b_digit, b_carry);
-      digit_type res_digit = op(a_digit, b_digit);
-      _data[i] = twos_complement(result_negative, res_digit, res_carry);
-    }
+  big_integer& bitwise_operation(const big_integer& rhs, BitwiseOperation op);
 
-    _negative = result_negative;
-    trim();
-    return *this;
-  }
+  // *this = |a| * |b|, a and b may alias *this
+  big_integer& abs_mul(const big_integer& a, const big_integer& b);
 
-  big_integer& abs_mul(const big_integer& rhs);
+  // *this = a << shift and *this = a >> shift, a may alias *this
+  big_integer& shift_left(const big_integer& a, size_t shift);
+  big_integer& shift_right(const big_integer& a, size_t shift);
 
-  int32_t normalize();
-
-  big_integer div_rem(big_integer rhs);
+  // quotient = |a| / |b|, remainder = |a| % |b|, remainder may alias a, quotient must not alias the inputs
+  static void abs_divmod(const big_integer& a, const big_integer& b, big_integer& quotient, big_integer& remainder);
 
   digit_type abs_divide_int(digit_type val);
 
@@ -65,9 +306,20 @@ private:
 
   big_integer& abs_mul_int(digit_type rhs);
 
+  // 10^(9 * 2^k)
+  static const big_integer& decimal_power(size_t k);
+
+  static big_integer parse_decimal(std::string_view digits);
+
+  // writes x < 10^(9 * 2^(k + 1)), with leading zeros up to that width if pad is set; nullptr if out of space
+  static char* write_decimal(big_integer x, size_t k, bool pad, char* first, char* last);
+
+  big_integer(const big_integer& other, size_t capacity);
+
 public:
   big_integer();
   big_integer(const big_integer& other);
+  big_integer(big_integer&& other) noexcept;
 
   big_integer(unsigned long long val, bool negative = false);
   big_integer(long long val);
@@ -78,18 +330,25 @@ public:
   big_integer(short val);
   big_integer(unsigned short val);
 
-  explicit big_integer(const std::string& str);
+  explicit big_integer(std::string_view str);
   ~big_integer();
 
   bool is_negative() const noexcept;
 
-  void swap(big_integer& other) noexcept(std::is_nothrow_swappable_v<std::vector<digit_type>>);
+  void swap(big_integer& other) noexcept;
 
   bool is_zero() const noexcept;
 
   big_integer& negate() noexcept;
 
+  // popcount and bit_length count the bits of |*this|, test_bit and set_bit act on two's complement
+  size_t popcount() const noexcept;
+  size_t bit_length() const noexcept;
+  bool test_bit(size_t bit) const noexcept;
+  big_integer& set_bit(size_t bit, bool value = true);
+
   big_integer& operator=(const big_integer& other);
+  big_integer& operator=(big_integer&& other) noexcept;
 
   big_integer& operator+=(const big_integer& rhs);
   big_integer& operator-=(const big_integer& rhs);
@@ -104,9 +363,12 @@ public:
   big_integer& operator<<=(int rhs);
   big_integer& operator>>=(int rhs);
 
-  big_integer operator+() const;
-  big_integer operator-() const;
-  big_integer operator~() const;
+  big_integer operator+() const&;
+  big_integer operator+() &&;
+  big_integer operator-() const&;
+  big_integer operator-() &&;
+  big_integer operator~() const&;
+  big_integer operator~() &&;
 
   big_integer& operator++();
   big_integer operator++(int);
@@ -114,6 +376,18 @@ public:
   big_integer& operator--();
   big_integer operator--(int);
 
+  friend big_integer operator+(const big_integer& a, const big_integer& b);
+  friend big_integer operator-(const big_integer& a, const big_integer& b);
+  friend big_integer operator*(const big_integer& a, const big_integer& b);
+  friend big_integer operator*(big_integer&& a, big_integer&& b);
+
+  friend big_integer operator&(const big_integer& a, const big_integer& b);
+  friend big_integer operator|(const big_integer& a, const big_integer& b);
+  friend big_integer operator^(const big_integer& a, const big_integer& b);
+
+  friend big_integer operator<<(const big_integer& a, int b);
+  friend big_integer operator>>(const big_integer& a, int b);
+
   friend bool operator==(const big_integer& a, const big_integer& b);
   friend bool operator!=(const big_integer& a, const big_integer& b);
   friend bool operator<(const big_integer& a, const big_integer& b);
@@ -121,21 +395,61 @@ public:
   friend bool operator<=(const big_integer& a, const big_integer& b);
   friend bool operator>=(const big_integer& a, const big_integer& b);
 
-  friend std::string to_string(const big_integer& a);
+  friend std::pair<big_integer, big_integer> divmod(const big_integer& a, const big_integer& b);
+  friend big_integer pow_mod(const big_integer& base, const big_integer& exp, const big_integer& mod);
+  friend class montgomery_context;
+
+  friend size_t to_chars_max_length(const big_integer& a) noexcept;
+  friend std::to_chars_result to_chars(char* first, char* last, const big_integer& a);
 };
 
 big_integer operator+(const big_integer& a, const big_integer& b);
+big_integer operator+(big_integer&& a, const big_integer& b);
+big_integer operator+(const big_integer& a, big_integer&& b);
+big_integer operator+(big_integer&& a, big_integer&& b);
+
 big_integer operator-(const big_integer& a, const big_integer& b);
+big_integer operator-(big_integer&& a, const big_integer& b);
+big_integer operator-(const big_integer& a, big_integer&& b);
+big_integer operator-(big_integer&& a, big_integer&& b);
+
 big_integer operator*(const big_integer& a, const big_integer& b);
+big_integer operator*(big_integer&& a, const big_integer& b);
+big_integer operator*(const big_integer& a, big_integer&& b);
+big_integer operator*(big_integer&& a, big_integer&& b);
+
 big_integer operator/(const big_integer& a, const big_integer& b);
+big_integer operator/(big_integer&& a, const big_integer& b);
+
 big_integer operator%(const big_integer& a, const big_integer& b);
+big_integer operator%(big_integer&& a, const big_integer& b);
+
+// truncated division, the remainder takes the sign of a
+std::pair<big_integer, big_integer> divmod(const big_integer& a, const big_integer& b);
+
+// base^exp mod m for exp >= 0 and mod > 0, the result is in [0, mod)
+big_integer pow_mod(const big_integer& base, const big_integer& exp, const big_integer& mod);
 
 big_integer operator&(const big_integer& a, const big_integer& b);
+big_integer operator&(big_integer&& a, const big_integer& b);
+big_integer operator&(const big_integer& a, big_integer&& b);
+big_integer operator&(big_integer&& a, big_integer&& b);
+
 big_integer operator|(const big_integer& a, const big_integer& b);
+big_integer operator|(big_integer&& a, const big_integer& b);
+big_integer operator|(const big_integer& a, big_integer&& b);
+big_integer operator|(big_integer&& a, big_integer&& b);
+
 big_integer operator^(const big_integer& a, const big_integer& b);
+big_integer operator^(big_integer&& a, const big_integer& b);
+big_integer operator^(const big_integer& a, big_integer&& b);
+big_integer operator^(big_integer&& a, big_integer&& b);
 
 big_integer operator<<(const big_integer& a, int b);
+big_integer operator<<(big_integer&& a, int b);
+
 big_integer operator>>(const big_integer& a, int b);
+big_integer operator>>(big_integer&& a, int b);
 
 bool operator==(const big_integer& a, const big_integer& b);
 bool operator!=(const big_integer& a, const big_integer& b);
@@ -144,5 +458,43 @@ bool operator>(const big_integer& a, const big_integer& b);
 bool operator<=(const big_integer& a, const big_integer& b);
 bool operator>=(const big_integer& a, const big_integer& b);
 
+size_t to_chars_max_length(const big_integer& a) noexcept;
+std::to_chars_result to_chars(char* first, char* last, const big_integer& a);
 std::string to_string(const big_integer& a);
 std::ostream& operator<<(std::ostream& out, const big_integer& a);
+
+// Montgomery arithmetic modulo a fixed odd m > 1 with R = 2^(32n), where n is the number of limbs of m.
+// mul, sqr and exp take and return residues in Montgomery form a * R mod m, reduced to [0, m).
+class montgomery_context {
+public:
+  explicit montgomery_context(const big_integer& mod);
+
+  const big_integer& modulus() const noexcept;
+
+  big_integer to_montgomery(const big_integer& a) const;
+  big_integer from_montgomery(const big_integer& a) const;
+
+  big_integer mul(const big_integer& a, const big_integer& b) const;
+  big_integer sqr(const big_integer& a) const;
+  big_integer exp(const big_integer& a, const big_integer& e) const;
+
+private:
+  using digit_type = big_integer::digit_type;
+
+  // r[0, n) = a[0, n) * b[0, n) / R mod m, r may alias a and b
+  void mul(digit_type* r, const digit_type* a, const digit_type* b, digit_type* scratch) const;
+  void sqr(digit_type* r, const digit_type* a, digit_type* scratch) const;
+
+  // r[0, n) = t[0, 2n) / R mod m, t < m * R is clobbered
+  void reduce(digit_type* r, digit_type* t) const;
+
+  size_t scratch_size() const noexcept;
+
+  void load(digit_type* r, const big_integer& a) const;
+  big_integer store(const digit_type* a) const;
+
+  big_integer _mod;
+  big_integer _r2;
+  size_t _size;
+  digit_type _inv;
+};
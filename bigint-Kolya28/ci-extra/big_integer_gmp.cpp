@@ -185,6 +185,12 @@ bool operator>=(const big_integer_gmp& a, const big_integer_gmp& b) {
   return mpz_cmp(a.mpz, b.mpz) >= 0;
 }
 
+big_integer_gmp pow_mod(const big_integer_gmp& base, const big_integer_gmp& exp, const big_integer_gmp& mod) {
+  big_integer_gmp res;
+  mpz_powm(res.mpz, base.mpz, exp.mpz, mod.mpz);
+  return res;
+}
+
 std::string to_string(const big_integer_gmp& a) {
   char* tmp = mpz_get_str(nullptr, 10, a.mpz);
   std::string res = tmp;
@@ -59,6 +59,8 @@ struct big_integer_gmp {
   friend bool operator>=(const big_integer_gmp& a, const big_integer_gmp& b);
 
   friend std::string to_string(const big_integer_gmp& a);
+  friend big_integer_gmp pow_mod(const big_integer_gmp& base, const big_integer_gmp& exp,
+                                 const big_integer_gmp& mod);
 
 private:
   mpz_t mpz;
@@ -85,4 +87,5 @@ bool operator<=(const big_integer_gmp& a, const big_integer_gmp& b);
 bool operator>=(const big_integer_gmp& a, const big_integer_gmp& b);
 
 std::string to_string(const big_integer_gmp& a);
+big_integer_gmp pow_mod(const big_integer_gmp& base, const big_integer_gmp& exp, const big_integer_gmp& mod);
 std::ostream& operator<<(std::ostream& s, const big_integer_gmp& a);
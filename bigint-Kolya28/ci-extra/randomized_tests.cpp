@@ -128,6 +128,16 @@ TEST(correctness_random, div_randomized) {
   }
 }
 
+TEST(correctness_random, string_conv_long) {
+  std::default_random_engine rng(42);
+  for (size_t size : {1000, 10000, 100000}) {
+    big_integer_gmp a;
+    a.random(size, rng);
+    std::string str = to_string(a);
+    EXPECT_EQ(str, to_string(big_integer(str)));
+  }
+}
+
 TEST(correctness_random, cmp) {
   std::default_random_engine rng(42);
   for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
@@ -180,6 +190,20 @@ TEST(correctness_random, mul) {
   }
 }
 
+TEST(correctness_random, mul_long) {
+  std::default_random_engine rng(42);
+  for (size_t a_size : {1024, 8192, 65536}) {
+    for (size_t b_size : {1024, 8192, 65536}) {
+      big_integer_gmp a, b;
+      a.random(a_size, rng);
+      b.random(b_size, rng);
+      big_integer_gmp c = a * b;
+      big_integer R = big_integer(to_string(a)) * big_integer(to_string(b));
+      EXPECT_EQ(to_string(c), to_string(R));
+    }
+  }
+}
+
 TEST(correctness_random, div) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
@@ -196,6 +220,20 @@ TEST(correctness_random, div) {
   }
 }
 
+TEST(correctness_random, div_long) {
+  std::default_random_engine rng(322);
+  for (size_t a_size : {8192, 65536, 262144}) {
+    for (size_t b_size : {2048, 8192, 65536}) {
+      big_integer_gmp a, b;
+      a.random(a_size, rng);
+      b.random(b_size, rng);
+      auto [q, r] = divmod(big_integer(to_string(a)), big_integer(to_string(b)));
+      EXPECT_EQ(to_string(a / b), to_string(q));
+      EXPECT_EQ(to_string(a % b), to_string(r));
+    }
+  }
+}
+
 TEST(correctness_random, mod) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
@@ -212,6 +250,23 @@ TEST(correctness_random, mod) {
   }
 }
 
+TEST(correctness_random, pow_mod) {
+  std::default_random_engine rng(42);
+  for (size_t mod_size : {64, 1024, 2048}) {
+    big_integer_gmp base, exp, mod, one(1);
+    base.random(mod_size * 2, rng);
+    exp.random(mod_size, rng);
+    mod.random(mod_size, rng);
+    exp = exp < 0 ? -exp : exp;
+    mod = mod < 0 ? -mod : mod;
+    for (big_integer_gmp m : {mod, mod | one}) {
+      big_integer_gmp r = pow_mod(base, exp, m);
+      big_integer R = pow_mod(big_integer(to_string(base)), big_integer(to_string(exp)), big_integer(to_string(m)));
+      EXPECT_EQ(to_string(r), to_string(R));
+    }
+  }
+}
+
 TEST(correctness_random, bitwise) {
   std::default_random_engine rng(42);
   for (size_t itn = 0; itn != NUMBER_OF_ITERATIONS; ++itn) {
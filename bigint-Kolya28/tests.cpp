@@ -7,6 +7,8 @@
 #include <cstdlib>
 #include <limits>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace {
 
@@ -117,6 +119,117 @@ TEST(correctness, assignment_return_value) {
   EXPECT_TRUE(b == 7);
 }
 
+TEST(correctness, assignment_small_large) {
+  big_integer small = 5;
+  big_integer large("123456789012345678901234567890123456789012345678901234567890");
+  big_integer a = small;
+
+  a = large;
+  EXPECT_EQ(large, a);
+  a = small;
+  EXPECT_EQ(5, a);
+  a.swap(large);
+  EXPECT_EQ(5, large);
+  EXPECT_EQ(big_integer("123456789012345678901234567890123456789012345678901234567890"), a);
+
+  big_integer b = 1;
+  for (int i = 0; i < 8; ++i) {
+    b *= big_integer(1) << 32;
+  }
+  for (int i = 0; i < 8; ++i) {
+    b /= big_integer(1) << 32;
+  }
+  EXPECT_EQ(1, b);
+}
+
+TEST(correctness, move_ctor) {
+  big_integer a("123456789012345678901234567890123456789012345678901234567890");
+  big_integer b = std::move(a);
+  EXPECT_EQ(big_integer("123456789012345678901234567890123456789012345678901234567890"), b);
+
+  a = 5;
+  EXPECT_EQ(5, a);
+}
+
+TEST(correctness, move_assignment) {
+  big_integer a("-123456789012345678901234567890123456789012345678901234567890");
+  big_integer b = 5;
+  b = std::move(a);
+  EXPECT_EQ(big_integer("-123456789012345678901234567890123456789012345678901234567890"), b);
+
+  big_integer c = 7;
+  b = std::move(c);
+  EXPECT_EQ(7, b);
+}
+
+TEST(correctness, rvalue_operators) {
+  big_integer a("100000000000000000000000000000000000000000");
+  big_integer b("-3");
+
+  EXPECT_EQ(big_integer("99999999999999999999999999999999999999997"), big_integer(a) + b);
+  EXPECT_EQ(big_integer("99999999999999999999999999999999999999997"), a + big_integer(b));
+  EXPECT_EQ(big_integer("100000000000000000000000000000000000000003"), big_integer(a) - b);
+  EXPECT_EQ(big_integer("-100000000000000000000000000000000000000003"), b - big_integer(a));
+  EXPECT_EQ(big_integer("-33333333333333333333333333333333333333333"), big_integer(a) / b);
+  EXPECT_EQ(1, big_integer(a) % b);
+  EXPECT_EQ(a & 255, big_integer(255) & a);
+  EXPECT_EQ(a | b, b | big_integer(a));
+  EXPECT_EQ(a ^ b, big_integer(a) ^ big_integer(b));
+  EXPECT_EQ(a * 32, big_integer(a) << 5);
+  EXPECT_EQ(a / 32, big_integer(a) >> 5);
+  EXPECT_EQ(-a, -big_integer(a));
+  EXPECT_EQ(-a - 1, ~big_integer(a));
+  EXPECT_EQ(a - a, a - big_integer(a));
+  EXPECT_EQ(big_integer("-300000000000000000000000000000000000000000"), big_integer(a) * b);
+  EXPECT_EQ(big_integer("-300000000000000000000000000000000000000000"), a * big_integer(b));
+  EXPECT_EQ(big_integer("-300000000000000000000000000000000000000000"), big_integer(a) * big_integer(b));
+  EXPECT_EQ(a * a, big_integer(a) * big_integer(a));
+  EXPECT_EQ(big_integer("-33333333333333333333333333333333333333333"), big_integer(a) / big_integer(b));
+}
+
+TEST(correctness, divmod_in_place) {
+  big_integer a("123456789012345678901234567890123456789012345678901234567890");
+  big_integer b("-98765432109876543210987654321");
+
+  big_integer q = a;
+  q /= b;
+  big_integer r = a;
+  r %= b;
+  EXPECT_EQ(big_integer("-1249999988609375000142382812499"), q);
+  EXPECT_EQ(big_integer("46440971104644097110464409711"), r);
+  EXPECT_EQ(a, q * b + r);
+
+  r = b;
+  r %= a;
+  EXPECT_EQ(b, r);
+  q = b;
+  q /= a;
+  EXPECT_EQ(0, q);
+
+  q = a;
+  q /= q;
+  EXPECT_EQ(1, q);
+  r = a;
+  r %= r;
+  EXPECT_EQ(0, r);
+}
+
+TEST(correctness, self_arithmetic) {
+  big_integer a("123456789012345678901234567890");
+
+  EXPECT_EQ(0, a - a);
+  EXPECT_EQ(a * 2, a + a);
+  EXPECT_EQ(1, a / a);
+  EXPECT_EQ(0, a % a);
+
+  big_integer b = a;
+  b -= b;
+  EXPECT_EQ(0, b);
+  b = a;
+  b *= b;
+  EXPECT_EQ(big_integer("15241578753238836750495351562536198787501905199875019052100"), b);
+}
+
 TEST(correctness, comparisons) {
   big_integer a = 100;
   big_integer b = 100;
@@ -428,6 +541,70 @@ TEST(correctness, xor_return_value) {
   EXPECT_EQ(2, a);
 }
 
+TEST(correctness, bitwise_signed_long) {
+  big_integer a = -(big_integer(1) << 31);
+  big_integer b = -big_integer(0x80000001U);
+  EXPECT_EQ(-(big_integer(1) << 32), a & b);
+
+  big_integer c("-340282366920938463463374607431768211456");
+  big_integer d("18446744073709551616");
+  EXPECT_EQ(0, c & d);
+  EXPECT_EQ(c + d, c | d);
+  EXPECT_EQ(c + d, c ^ d);
+  EXPECT_EQ(c, c & -d);
+  EXPECT_EQ(-d, c | -d);
+  EXPECT_EQ(-d - c, c ^ -d);
+}
+
+TEST(correctness, bitwise_self) {
+  big_integer a("-123456789012345678901234567890");
+  big_integer b = a;
+  b &= b;
+  EXPECT_EQ(a, b);
+  b |= b;
+  EXPECT_EQ(a, b);
+  b ^= b;
+  EXPECT_EQ(0, b);
+}
+
+TEST(correctness, bit_queries) {
+  big_integer a("340282366920938463463374607431768211457");
+  EXPECT_EQ(129, a.bit_length());
+  EXPECT_EQ(2, a.popcount());
+  EXPECT_EQ(129, (-a).bit_length());
+  EXPECT_EQ(2, (-a).popcount());
+  EXPECT_EQ(0, big_integer().bit_length());
+  EXPECT_EQ(0, big_integer().popcount());
+
+  EXPECT_TRUE(a.test_bit(0));
+  EXPECT_FALSE(a.test_bit(1));
+  EXPECT_TRUE(a.test_bit(128));
+  EXPECT_FALSE(a.test_bit(1000));
+
+  big_integer b = -12;
+  for (size_t bit = 0; bit < 100; ++bit) {
+    EXPECT_EQ(bit == 2 || bit >= 4, b.test_bit(bit));
+  }
+}
+
+TEST(correctness, set_bit) {
+  big_integer a;
+  a.set_bit(100);
+  EXPECT_EQ(big_integer(1) << 100, a);
+  a.set_bit(0).set_bit(100, false);
+  EXPECT_EQ(1, a);
+  a.set_bit(1000, false);
+  EXPECT_EQ(1, a);
+
+  big_integer b = -12;
+  b.set_bit(0);
+  EXPECT_EQ(-11, b);
+  b.set_bit(2, false);
+  EXPECT_EQ(-15, b);
+  b.set_bit(200, false);
+  EXPECT_EQ(-15 - (big_integer(1) << 200), b);
+}
+
 TEST(correctness, not_) {
   big_integer a = 0xaa;
   big_integer b = ~a;
@@ -480,6 +657,16 @@ TEST(correctness, shr_signed) {
   EXPECT_EQ(-155, a);
 }
 
+TEST(correctness, shr_signed_exact) {
+  EXPECT_EQ(-2, big_integer(-4) >> 1);
+  EXPECT_EQ(-1, big_integer(-4) >> 2);
+  EXPECT_EQ(-1, big_integer(-4) >> 3);
+  EXPECT_EQ(-1, big_integer(-1) >> 100);
+  EXPECT_EQ(0, big_integer(1) >> 100);
+  EXPECT_EQ(big_integer("-4294967296"), big_integer("-18446744073709551616") >> 32);
+  EXPECT_EQ(big_integer("-4294967297"), big_integer("-18446744073709551617") >> 32);
+}
+
 TEST(correctness, shr_return_value) {
   big_integer a = 64;
 
@@ -583,6 +770,24 @@ TEST(correctness, mul_long_pow2) {
   EXPECT_EQ(c, b * b);
 }
 
+TEST(correctness, mul_long_all_ones) {
+  for (int bits : {1600, 6400, 64000}) {
+    big_integer a = (big_integer(1) << bits) - 1;
+    big_integer b = (big_integer(1) << (2 * bits)) - (big_integer(1) << (bits + 1)) + 1;
+
+    EXPECT_EQ(b, a * a);
+  }
+}
+
+TEST(correctness, mul_long_unbalanced) {
+  big_integer a = (big_integer(1) << 40000) - 1;
+  big_integer b = (big_integer(1) << 3000) + 1;
+  big_integer c = (big_integer(1) << 43000) + (big_integer(1) << 40000) - (big_integer(1) << 3000) - 1;
+
+  EXPECT_EQ(c, a * b);
+  EXPECT_EQ(c, b * a);
+}
+
 TEST(correctness, div_0_long) {
   big_integer a;
   big_integer b("100000000000000000000000000000000000000000000000000000000000");
@@ -616,6 +821,88 @@ TEST(correctness, div_long_signed2) {
   EXPECT_EQ(c, a / b);
 }
 
+TEST(correctness, div_long_recursive) {
+  big_integer one = 1;
+  big_integer a = (one << 12800) - 1;
+  big_integer b = (one << 6400) - 1;
+
+  EXPECT_EQ((one << 6400) + 1, a / b);
+  EXPECT_EQ(0, a % b);
+
+  big_integer d = (one << 9000) + (one << 4321) + 12345;
+  big_integer q = (one << 7000) - 1;
+  big_integer r = d - 1;
+  EXPECT_EQ(q, (d * q + r) / d);
+  EXPECT_EQ(r, (d * q + r) % d);
+  EXPECT_EQ(-q, (-d * q - r) / d);
+  EXPECT_EQ(-r, (-d * q - r) % d);
+}
+
+TEST(correctness, divmod) {
+  for (int a : {-7, -6, 0, 6, 7}) {
+    for (int b : {-2, 2}) {
+      auto [q, r] = divmod(a, b);
+      EXPECT_EQ(a / b, q);
+      EXPECT_EQ(a % b, r);
+    }
+  }
+
+  big_integer a("-1000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000007");
+  big_integer b("100000000000000000000000000000000000000");
+  auto [q, r] = divmod(a, b);
+  EXPECT_EQ(a / b, q);
+  EXPECT_EQ(a % b, r);
+  EXPECT_EQ(-7, r);
+  EXPECT_EQ(a, q * b + r);
+}
+
+TEST(correctness, pow_mod) {
+  EXPECT_EQ(445, pow_mod(4, 13, 497));
+  EXPECT_EQ(52, pow_mod(-4, 13, 497));
+  EXPECT_EQ(1, pow_mod(123, 0, 497));
+  EXPECT_EQ(0, pow_mod(123, 0, 1));
+  EXPECT_EQ(0, pow_mod(0, 5, 497));
+  EXPECT_EQ(376, pow_mod(2, 100, 1000));
+  EXPECT_EQ(big_integer("127405800796189932058661803090241077547"),
+            pow_mod(big_integer("12345678901234567890123456789"), big_integer("98765432109876543210"),
+                    big_integer("340282366920938463463374607431768211507")));
+
+  EXPECT_THROW(pow_mod(2, 3, 0), std::invalid_argument);
+  EXPECT_THROW(pow_mod(2, 3, -5), std::invalid_argument);
+  EXPECT_THROW(pow_mod(2, -3, 5), std::invalid_argument);
+}
+
+TEST(correctness, pow_mod_fermat) {
+  big_integer one = 1;
+  for (int p : {127, 521, 1279}) {
+    big_integer m = (one << p) - 1;
+    for (int a : {2, 3, 10}) {
+      EXPECT_EQ(1, pow_mod(a, m - 1, m));
+    }
+  }
+}
+
+TEST(correctness, montgomery_context) {
+  big_integer m("340282366920938463463374607431768211507");
+  montgomery_context context(m);
+  EXPECT_EQ(m, context.modulus());
+
+  big_integer a("123456789012345678901234567890123456789012345");
+  big_integer b("-98765432109876543210");
+  big_integer am = context.to_montgomery(a);
+  big_integer bm = context.to_montgomery(b);
+  EXPECT_EQ(a % m, context.from_montgomery(am));
+  EXPECT_EQ(a * b % m + m, context.from_montgomery(context.mul(am, bm)));
+  EXPECT_EQ(a * a % m, context.from_montgomery(context.sqr(am)));
+  EXPECT_EQ(context.sqr(am), context.mul(am, am));
+  EXPECT_EQ(pow_mod(a, 65537, m), context.from_montgomery(context.exp(am, 65537)));
+  EXPECT_EQ(1, context.from_montgomery(context.exp(am, 0)));
+
+  EXPECT_THROW(montgomery_context(10), std::invalid_argument);
+  EXPECT_THROW(montgomery_context(1), std::invalid_argument);
+  EXPECT_THROW(context.exp(am, -1), std::invalid_argument);
+}
+
 TEST(correctness, negation_long) {
   big_integer a("10000000000000000000000000000000000000000000000000000");
   big_integer c("-10000000000000000000000000000000000000000000000000000");
@@ -636,6 +923,18 @@ TEST(correctness, shl_long) {
             big_integer("12341236412857618761234871264871264128736412836643859238479") << 31);
 }
 
+TEST(correctness, shl_shr_long_limbs) {
+  big_integer a("123456789012345678901234567890123456789012345678901234567890");
+  for (int shift : {0, 1, 31, 32, 33, 64, 95, 1000}) {
+    big_integer b = a << shift;
+    EXPECT_EQ(a, b >> shift);
+    b >>= shift;
+    EXPECT_EQ(a, b);
+    b <<= shift;
+    EXPECT_EQ(a * (big_integer(1) << shift), b);
+  }
+}
+
 TEST(correctness, shr_long) {
   EXPECT_EQ(big_integer("4730073393008085198307104580698364137020387111323398632330851"),
             big_integer("151362348576258726345827346582347652384652387562348756234587245") >> 5);
@@ -664,6 +963,52 @@ TEST(correctness, string_conv) {
   EXPECT_EQ("-2147483649", to_string(lim));
 }
 
+TEST(correctness, string_conv_long) {
+  big_integer power = 1;
+  std::string digits = "1";
+  for (size_t i = 1; i <= 5000; ++i) {
+    power *= 10;
+    digits.push_back('0');
+    if (i % 97 == 0 || i % 288 == 0 || i % 576 == 0) {
+      EXPECT_EQ(power, big_integer(digits));
+      EXPECT_EQ(digits, to_string(power));
+      EXPECT_EQ('-' + std::string(i, '9'), to_string(1 - power));
+    }
+  }
+
+  std::string long_number(30000, '7');
+  long_number[0] = '-';
+  long_number[12345] = '0';
+  EXPECT_EQ(long_number, to_string(big_integer(long_number)));
+}
+
+TEST(correctness, string_view_ctor) {
+  std::string_view str = "xx-12345678901234567890xx";
+  EXPECT_EQ(big_integer("-12345678901234567890"), big_integer(str.substr(2, 21)));
+  EXPECT_THROW(big_integer(str.substr(2, 22)), std::invalid_argument);
+}
+
+TEST(correctness, to_chars) {
+  big_integer a("-12345678901234567890");
+  std::string buffer(to_chars_max_length(a), 'x');
+  EXPECT_GE(buffer.size(), 21);
+
+  std::to_chars_result res = to_chars(buffer.data(), buffer.data() + buffer.size(), a);
+  EXPECT_EQ(std::errc(), res.ec);
+  EXPECT_EQ("-12345678901234567890", std::string_view(buffer.data(), res.ptr));
+
+  res = to_chars(buffer.data(), buffer.data() + 21, a);
+  EXPECT_EQ(std::errc(), res.ec);
+  EXPECT_EQ(buffer.data() + 21, res.ptr);
+
+  res = to_chars(buffer.data(), buffer.data() + 20, a);
+  EXPECT_EQ(std::errc::value_too_large, res.ec);
+  EXPECT_EQ(buffer.data() + 20, res.ptr);
+
+  res = to_chars(buffer.data(), buffer.data(), big_integer());
+  EXPECT_EQ(std::errc::value_too_large, res.ec);
+}
+
 namespace {
 template <typename T>
 void test_converting_ctor(T value) {
@@ -0,0 +1,129 @@
+#include "list.h"
+#include "unrolled-list.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Traversal and modification of list, unrolled_list and std::vector of ints, each line is the mean time of one run
+// and the time per touched element. Every run leaves the container as it found it:
+//   scan          sums all the elements
+//   insert        inserts BATCH elements at a cursor in the middle, then removes them by one range erase
+//   insert_erase  inserts BATCH elements at the cursor, then erases them one by one
+// Usage:
+//   benchmark [--min-time SECONDS] [--filter SUBSTRING]
+
+namespace {
+
+constexpr size_t BATCH = 1000;
+
+struct options {
+  double min_time = 0.2;
+  std::string_view filter;
+};
+
+options opts;
+
+// prevents the compiler from dropping a result or fusing consecutive runs
+template <class T>
+void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "g"(&value) : "memory");
+#else
+  static const void* volatile sink;
+  sink = &value;
+#endif
+}
+
+template <class Run>
+double seconds_per_run(const Run& run) {
+  using clock = std::chrono::steady_clock;
+  run();
+  size_t runs = 0;
+  double elapsed = 0;
+  auto start = clock::now();
+  do {
+    run();
+    ++runs;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < opts.min_time);
+  return elapsed / runs;
+}
+
+template <class Run>
+void measure(std::string_view name, size_t size, size_t touched, const Run& run) {
+  if (name.find(opts.filter) == std::string_view::npos) {
+    return;
+  }
+  double seconds = seconds_per_run(run);
+  std::printf("%-28.*s %9zu %12.2f us %9.2f ns/element\n", static_cast<int>(name.size()), name.data(), size,
+              seconds * 1e6, seconds / touched * 1e9);
+  std::fflush(stdout);
+}
+
+template <class Container>
+void run_all(const char* type, size_t size) {
+  std::vector<int> values(size);
+  std::iota(values.begin(), values.end(), 0);
+  Container c(values.begin(), values.end());
+  auto cursor = std::next(c.begin(), size / 2);
+  auto name = [type](const char* workload) { return std::string(workload) + "/" + type; };
+
+  measure(name("scan"), size, size, [&] { keep(std::accumulate(c.begin(), c.end(), 0L)); });
+  // the iterators returned by insert and erase keep the cursor valid for all three containers
+  measure(name("insert"), size, BATCH, [&] {
+    for (size_t i = 0; i < BATCH; ++i) {
+      cursor = c.insert(cursor, static_cast<int>(i));
+    }
+    cursor = c.erase(cursor, std::next(cursor, BATCH));
+    keep(c);
+  });
+  measure(name("insert_erase"), size, 2 * BATCH, [&] {
+    for (size_t i = 0; i < BATCH; ++i) {
+      cursor = c.insert(cursor, static_cast<int>(i));
+    }
+    for (size_t i = 0; i < BATCH; ++i) {
+      cursor = c.erase(cursor);
+    }
+    keep(c);
+  });
+}
+
+bool parse(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (i + 1 == argc) {
+      return false;
+    }
+    if (arg == "--min-time") {
+      opts.min_time = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--filter") {
+      opts.filter = argv[++i];
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (!parse(argc, argv)) {
+    std::fprintf(stderr, "usage: %s [--min-time SECONDS] [--filter SUBSTRING]\n", argv[0]);
+    return 1;
+  }
+#ifndef NDEBUG
+  std::printf("assertions are enabled, configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers\n");
+#endif
+
+  for (size_t size : {size_t{10'000}, size_t{1'000'000}}) {
+    run_all<list<int>>("list", size);
+    run_all<unrolled_list<int>>("unrolled_list", size);
+    run_all<std::vector<int>>("vector", size);
+  }
+}
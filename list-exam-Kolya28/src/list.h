@@ -1,12 +1,95 @@
 #pragma once
 
+#include <cassert>
 #include <cstddef>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+
+// Size of a list kept up to date by every operation, so splicing a part of another list counts the moved nodes
+// unless the caller passes their number.
+class list_exact_size {
+public:
+  static constexpr bool COUNTS_SPLICED = true;
+
+  template <typename Count>
+  size_t get(Count) const noexcept {
+    return _count;
+  }
+
+  void add(size_t n) noexcept {
+    _count += n;
+  }
+
+  void subtract(size_t n) noexcept {
+    _count -= n;
+  }
+
+  void set(size_t n) noexcept {
+    _count = n;
+  }
+
+  void take(list_exact_size& other) noexcept {
+    _count += std::exchange(other._count, 0);
+  }
+
+private:
+  size_t _count = 0;
+};
+
+// Size of a list forgotten by splicing a part of another list, so that every splice is O(1). The next size() counts
+// the nodes in O(n) and remembers the result.
+class list_lazy_size {
+public:
+  static constexpr bool COUNTS_SPLICED = false;
+
+  template <typename Count>
+  size_t get(Count count) const noexcept {
+    if (!_known) {
+      _count = count();
+      _known = true;
+    }
+    return _count;
+  }
+
+  void add(size_t n) noexcept {
+    _count += n;
+  }
+
+  void subtract(size_t n) noexcept {
+    _count -= n;
+  }
+
+  void set(size_t n) noexcept {
+    _count = n;
+    _known = true;
+  }
 
-template <typename T>
+  void take(list_lazy_size& other) noexcept {
+    bool other_known = std::exchange(other._known, true);
+    _count += std::exchange(other._count, 0);
+    _known = _known && other_known;
+  }
+
+  void forget() noexcept {
+    _known = false;
+  }
+
+private:
+  mutable size_t _count = 0;
+  mutable bool _known = true;
+};
+
+// Nodes are allocated by Allocator rebound to the node type, see node-pool.h for a pool allocator. SizePolicy is
+// list_exact_size or list_lazy_size.
+template <typename T, typename Allocator = std::allocator<T>, typename SizePolicy = list_exact_size>
 class list {
 public:
   using value_type = T;
+  using allocator_type = Allocator;
 
   using reference = T&;
   using const_reference = const T&;
@@ -30,9 +113,8 @@ private:
   };
 
   struct value_node : node {
-    value_node(const value_type& value) : value(value) {}
-
-    value_node(const value_type& value, node* prev, node* next) : node(prev, next), value(value) {}
+    template <typename... Args>
+    explicit value_node(std::in_place_t, Args&&... args) : value(std::forward<Args>(args)...) {}
 
     value_type value;
   };
@@ -93,8 +175,124 @@ private:
     friend bool operator==(const basic_list_iterator& left, const basic_list_iterator& right) noexcept = default;
   };
 
-  size_t _size;
+  using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<value_node>;
+  using node_traits = std::allocator_traits<node_allocator>;
+
+  SizePolicy _size;
   node _root;
+  [[no_unique_address]] node_allocator _alloc;
+
+  template <typename... Args>
+  value_node* create_node(Args&&... args) {
+    value_node* new_node = node_traits::allocate(_alloc, 1);
+    try {
+      node_traits::construct(_alloc, new_node, std::in_place, std::forward<Args>(args)...);
+    } catch (...) {
+      node_traits::deallocate(_alloc, new_node, 1);
+      throw;
+    }
+    return new_node;
+  }
+
+  void destroy_node(node* old_node) noexcept {
+    auto* temp = static_cast<value_node*>(old_node);
+    node_traits::destroy(_alloc, temp);
+    node_traits::deallocate(_alloc, temp, 1);
+  }
+
+  void link_before(node* pos, node* new_node) noexcept {
+    pos->prev->link_next(new_node);
+    new_node->link_next(pos);
+    _size.add(1);
+  }
+
+  // moves [first, last) before pos, which shouldn't be in the range
+  static void link_range(node* pos, node* first, node* last) noexcept {
+    node* cp = pos->prev;
+    last->prev->link_next(pos);
+    first->prev->link_next(last);
+    cp->link_next(first);
+  }
+
+  static T& value_of(node* n) noexcept {
+    return static_cast<value_node*>(n)->value;
+  }
+
+  // Nodes linked by next and ended by nullptr, the prev of every node but the first points to the one before it.
+  struct chain {
+    node* first = nullptr;
+    node* last = nullptr;
+  };
+
+  static chain concat_chains(chain left, chain right) noexcept {
+    if (left.first == nullptr) {
+      return right;
+    }
+    if (right.first != nullptr) {
+      left.last->next = right.first;
+      left.last = right.last;
+    }
+    return left;
+  }
+
+  // Merges the sorted non-empty chains left and right into left, equal elements of left go first. The nodes are
+  // linked both ways as they are taken, so the result needs no extra pass. If comp throws, left is a chain of all
+  // the nodes linked by next only, in no particular order.
+  template <typename Compare>
+  static void merge_chains(chain& left, chain& right, Compare& comp) {
+    node head;
+    node* tail = &head;
+    node* l = left.first;
+    node* r = right.first;
+    try {
+      while (l != nullptr && r != nullptr) {
+        if (comp(value_of(r), value_of(l))) {
+          tail->link_next(r);
+          tail = r;
+          r = r->next;
+        } else {
+          tail->link_next(l);
+          tail = l;
+          l = l->next;
+        }
+      }
+    } catch (...) {
+      tail->next = l;
+      left.last->next = r;
+      left = {head.next, right.last};
+      right = {};
+      throw;
+    }
+    if (l != nullptr) {
+      tail->link_next(l);
+    } else {
+      tail->link_next(r);
+      left.last = right.last;
+    }
+    left.first = head.next;
+    right = {};
+  }
+
+  // links the nodes of a chain linked by next only back between the ends of the root
+  void link_chain(node* first) noexcept {
+    node* last = &_root;
+    for (; first != nullptr; first = first->next) {
+      last->link_next(first);
+      last = first;
+    }
+    last->link_next(&_root);
+  }
+
+  void swap_nodes(list& other) noexcept {
+    node* lp = _root.prev;
+    node* ln = _root.next;
+    node* rp = other._root.prev;
+    node* rn = other._root.next;
+    ln->prev = lp->next = &other._root;
+    rn->prev = rp->next = &_root;
+    std::swap(_root, other._root);
+    std::swap(_size, other._size);
+  }
 
 public:
   using iterator = basic_list_iterator<value_type>;
@@ -103,24 +301,133 @@ public:
   using reverse_iterator = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+  // Owner of a node extracted from a list. Its element can be changed and the node can be put back into a list
+  // with an equal allocator without an allocation or a copy.
+  class node_type {
+    friend list;
+
+  public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+  private:
+    value_node* _node = nullptr;
+    std::optional<node_allocator> _alloc;
+
+    node_type(value_node* node, const node_allocator& alloc) noexcept : _node(node), _alloc(alloc) {}
+
+    void reset() noexcept {
+      if (_node != nullptr) {
+        node_traits::destroy(*_alloc, _node);
+        node_traits::deallocate(*_alloc, _node, 1);
+        _node = nullptr;
+      }
+    }
+
+  public:
+    node_type() noexcept = default;
+
+    node_type(node_type&& other) noexcept
+        : _node(std::exchange(other._node, nullptr)),
+          _alloc(std::move(other._alloc)) {}
+
+    node_type& operator=(node_type&& other) noexcept {
+      if (&other != this) {
+        reset();
+        _node = std::exchange(other._node, nullptr);
+        // emplaced, as allocators need not be assignable
+        _alloc.reset();
+        if (other._alloc) {
+          _alloc.emplace(std::move(*other._alloc));
+        }
+      }
+      return *this;
+    }
+
+    ~node_type() noexcept {
+      reset();
+    }
+
+    bool empty() const noexcept {
+      return _node == nullptr;
+    }
+
+    explicit operator bool() const noexcept {
+      return !empty();
+    }
+
+    T& value() const noexcept {
+      assert(!empty() && "Getting value of empty node handle");
+      return _node->value;
+    }
+
+    allocator_type get_allocator() const noexcept {
+      return allocator_type(*_alloc);
+    }
+  };
+
 public:
   // O(1), nothrow
-  list() noexcept : _size(0), _root(&_root, &_root) {}
+  list() noexcept(noexcept(Allocator())) : list(Allocator()) {}
+
+  // O(1), nothrow
+  explicit list(const Allocator& alloc) noexcept : _size(), _root(&_root, &_root), _alloc(alloc) {}
 
   // O(n), strong
-  list(const list& other) : list(other.begin(), other.end()) {}
+  list(const list& other)
+      : list(other.begin(), other.end(),
+             std::allocator_traits<Allocator>::select_on_container_copy_construction(other.get_allocator())) {}
+
+  // O(n), strong
+  list(const list& other, const Allocator& alloc) : list(other.begin(), other.end(), alloc) {}
+
+  // O(1), nothrow
+  list(list&& other) noexcept : _size(), _root(&_root, &_root), _alloc(std::move(other._alloc)) {
+    swap_nodes(other);
+  }
 
   // O(n), strong
   template <std::input_iterator InputIt>
-  list(InputIt first, InputIt last) : list() {
+  list(InputIt first, InputIt last, const Allocator& alloc = Allocator()) : list(alloc) {
     std::copy(first, last, std::back_inserter(*this));
   }
 
   // O(n), strong
   list& operator=(const list& other) {
     if (&other != this) {
-      list copy = other;
-      swap(*this, copy);
+      if constexpr (node_traits::propagate_on_container_copy_assignment::value) {
+        list copy(other, other.get_allocator());
+        swap_nodes(copy);
+        // the old nodes go with their allocator
+        using std::swap;
+        swap(_alloc, copy._alloc);
+      } else {
+        list copy(other, get_allocator());
+        swap_nodes(copy);
+      }
+    }
+    return *this;
+  }
+
+  // O(n) to destroy the old elements, O(1) with an allocator that propagates or is equal to the one of other,
+  // nothrow. Otherwise the elements are moved one by one, O(n) and strong.
+  list& operator=(list&& other) noexcept(node_traits::propagate_on_container_move_assignment::value ||
+                                         node_traits::is_always_equal::value) {
+    if (&other == this) {
+      return *this;
+    }
+    if constexpr (node_traits::propagate_on_container_move_assignment::value) {
+      clear();
+      swap_nodes(other);
+      _alloc = std::move(other._alloc);
+    } else {
+      if (_alloc == other._alloc) {
+        clear();
+        swap_nodes(other);
+      } else {
+        list copy(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()), get_allocator());
+        swap_nodes(copy);
+      }
     }
     return *this;
   }
@@ -130,14 +437,20 @@ public:
     clear();
   }
 
+  // O(1), nothrow
+  allocator_type get_allocator() const noexcept {
+    return allocator_type(_alloc);
+  }
+
   // O(1), nothrow
   bool empty() const noexcept {
-    return _size == 0;
+    return _root.next == &_root;
   }
 
   // O(1), nothrow
+  // with list_lazy_size O(n) after splicing a part of another list
   size_t size() const noexcept {
-    return _size;
+    return _size.get([this] { return static_cast<size_t>(std::distance(begin(), end())); });
   }
 
   // O(1), nothrow
@@ -165,11 +478,33 @@ public:
     insert(begin(), val);
   }
 
+  // O(1), strong
+  void push_front(T&& val) {
+    insert(begin(), std::move(val));
+  }
+
   // O(1), strong
   void push_back(const T& val) {
     insert(end(), val);
   }
 
+  // O(1), strong
+  void push_back(T&& val) {
+    insert(end(), std::move(val));
+  }
+
+  // O(1), strong
+  template <typename... Args>
+  T& emplace_front(Args&&... args) {
+    return *emplace(begin(), std::forward<Args>(args)...);
+  }
+
+  // O(1), strong
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    return *emplace(end(), std::forward<Args>(args)...);
+  }
+
   // O(1), nothrow
   void pop_front() noexcept {
     erase(begin());
@@ -222,27 +557,56 @@ public:
 
   // O(n), nothrow
   void clear() noexcept {
-    while (!empty()) {
-      pop_back();
-    }
+    erase(begin(), end());
+    _size.set(0);
   }
 
   // O(1), strong
   iterator insert(const_iterator pos, const T& val) {
-    node* new_node = new value_node(val);
-    pos._node->prev->link_next(new_node);
-    new_node->link_next(pos._node);
-    ++_size;
+    return emplace(pos, val);
+  }
+
+  // O(1), strong
+  iterator insert(const_iterator pos, T&& val) {
+    return emplace(pos, std::move(val));
+  }
+
+  // O(1), strong
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    node* new_node = create_node(std::forward<Args>(args)...);
+    link_before(pos._node, new_node);
+    return iterator(new_node);
+  }
+
+  // O(1), nothrow
+  // the allocator of the node should be equal to the one of this list, an empty node is ignored
+  iterator insert(const_iterator pos, node_type&& handle) noexcept {
+    if (handle.empty()) {
+      return iterator(pos._node);
+    }
+    assert(handle.get_allocator() == get_allocator() && "Inserting node with different allocator");
+    node* new_node = std::exchange(handle._node, nullptr);
+    link_before(pos._node, new_node);
     return iterator(new_node);
   }
 
+  // O(1), nothrow
+  // unlinks the node of pos, which stays allocated until the returned handle is destroyed
+  node_type extract(const_iterator pos) noexcept {
+    node* temp = pos._node;
+    temp->prev->link_next(temp->next);
+    _size.subtract(1);
+    return node_type(static_cast<value_node*>(temp), _alloc);
+  }
+
   // O(last - first), strong
   template <std::input_iterator InputIt>
   iterator insert(const_iterator pos, InputIt first, InputIt last) {
     if (first == last) {
       return iterator(pos._node);
     }
-    list temp(first, last);
+    list temp(first, last, get_allocator());
     auto b = temp.begin();
     splice(pos, temp, temp.begin(), temp.end());
     return b;
@@ -250,51 +614,209 @@ public:
 
   // O(1), nothrow
   iterator erase(const_iterator pos) noexcept {
-    value_node* temp = static_cast<value_node*>(pos._node);
+    node* temp = pos._node;
     node* next = temp->next;
     temp->prev->link_next(next);
-    delete temp;
-    _size--;
+    destroy_node(temp);
+    _size.subtract(1);
     return iterator(next);
   }
 
   // O(last - first), nothrow
   iterator erase(const_iterator first, const_iterator last) noexcept {
-    list temp;
-    auto it = iterator(last._node);
-    temp.splice(temp.begin(), *this, first, last);
-    return it;
+    node* end_node = last._node;
+    node* current = first._node;
+    current->prev->link_next(end_node);
+    size_t count = 0;
+    while (current != end_node) {
+      node* next = current->next;
+      destroy_node(current);
+      current = next;
+      ++count;
+    }
+    _size.subtract(count);
+    return iterator(end_node);
   }
 
   // O(last - first) in general but O(1) when possible, nothrow
+  // O(1) for the whole other, within this list and with list_lazy_size
+  // the allocators of both lists should be equal
   void splice(const_iterator pos, list& other, const_iterator first, const_iterator last) noexcept {
+    assert(get_allocator() == other.get_allocator() && "Splice between lists with different allocators");
     if (first == last) {
       return;
     }
     if (this != &other) {
-      ptrdiff_t diff = other.size();
-      if (first != other.begin() || last != other.end()) {
-        diff = std::distance(first, last);
+      if (first == other.begin() && last == other.end()) {
+        _size.take(other._size);
+      } else if constexpr (SizePolicy::COUNTS_SPLICED) {
+        size_t count = std::distance(first, last);
+        other._size.subtract(count);
+        _size.add(count);
+      } else {
+        other._size.forget();
+        _size.forget();
       }
-      other._size -= diff;
-      _size += diff;
     }
+    link_range(pos._node, first._node, last._node);
+  }
+
+  // O(1), nothrow
+  // count should be the distance from first to last
+  void splice(const_iterator pos, list& other, const_iterator first, const_iterator last, size_t count) noexcept {
+    assert(get_allocator() == other.get_allocator() && "Splice between lists with different allocators");
+    if (first == last) {
+      return;
+    }
+    if (this != &other) {
+      other._size.subtract(count);
+      _size.add(count);
+    }
+    link_range(pos._node, first._node, last._node);
+  }
 
-    node* cp = pos._node->prev;
-    last._node->prev->link_next(pos._node);
-    first._node->prev->link_next(last._node);
-    cp->link_next(first._node);
+  // O(n log n), basic, stable
+  // relinks the nodes in place, nothing is allocated or copied
+  template <typename Compare = std::less<>>
+  void sort(Compare comp = Compare()) {
+    if (_root.next == _root.prev) {
+      return;
+    }
+    // bins[i] is either empty or a sorted chain of 2^i nodes, preceding the nodes of bins[i - 1]
+    chain bins[std::numeric_limits<size_t>::digits];
+    size_t bins_used = 0;
+    chain rest{_root.next, _root.prev};
+    chain carry;
+    rest.last->next = nullptr;
+    try {
+      while (rest.first != nullptr) {
+        carry = {rest.first, rest.first};
+        rest.first = rest.first->next;
+        carry.first->next = nullptr;
+        size_t i = 0;
+        for (; bins[i].first != nullptr; ++i) {
+          merge_chains(bins[i], carry, comp);
+          carry = std::exchange(bins[i], {});
+        }
+        bins[i] = std::exchange(carry, {});
+        bins_used = std::max(bins_used, i + 1);
+      }
+      for (size_t i = 0; i < bins_used; ++i) {
+        if (bins[i].first != nullptr) {
+          if (carry.first != nullptr) {
+            merge_chains(bins[i], carry, comp);
+          }
+          carry = std::exchange(bins[i], {});
+        }
+      }
+    } catch (...) {
+      carry = concat_chains(carry, rest);
+      for (size_t i = 0; i < bins_used; ++i) {
+        carry = concat_chains(bins[i], carry);
+      }
+      link_chain(carry.first);
+      throw;
+    }
+    // the list has at least two nodes, so the merged chain is never empty, the check tells that to the compiler
+    if (carry.first == nullptr) {
+      return;
+    }
+    _root.link_next(carry.first);
+    carry.last->link_next(&_root);
+  }
+
+  // O(size() + other.size()), basic, stable
+  // both lists should be sorted, equal elements of this list go first and other is left empty
+  template <typename Compare = std::less<>>
+  void merge(list& other, Compare comp = Compare()) {
+    if (&other == this) {
+      return;
+    }
+    assert(get_allocator() == other.get_allocator() && "Merge of lists with different allocators");
+    node* current = _root.next;
+    node* other_current = other._root.next;
+    size_t moved = 0;
+    try {
+      while (current != &_root && other_current != &other._root) {
+        if (comp(value_of(other_current), value_of(current))) {
+          node* next = other_current->next;
+          link_range(current, other_current, next);
+          other_current = next;
+          ++moved;
+        } else {
+          current = current->next;
+        }
+      }
+    } catch (...) {
+      other._size.subtract(moved);
+      _size.add(moved);
+      throw;
+    }
+    if (other_current != &other._root) {
+      link_range(&_root, other_current, &other._root);
+    }
+    _size.take(other._size);
+  }
+
+  // O(n), basic
+  // erases all but the first of each run of consecutive elements for which pred holds, returns the number erased
+  template <typename BinaryPredicate = std::equal_to<>>
+  size_t unique(BinaryPredicate pred = BinaryPredicate()) {
+    if (empty()) {
+      return 0;
+    }
+    size_t count = 0;
+    node* first = _root.next;
+    for (node* next = first->next; next != &_root; next = first->next) {
+      if (pred(value_of(first), value_of(next))) {
+        erase(const_iterator(next));
+        ++count;
+      } else {
+        first = next;
+      }
+    }
+    return count;
+  }
+
+  // O(n), basic
+  // erases the elements for which pred holds, returns the number erased
+  template <typename UnaryPredicate>
+  size_t remove_if(UnaryPredicate pred) {
+    // erased at the end, pred may refer to one of the elements
+    list removed(get_allocator());
+    for (node* current = _root.next; current != &_root;) {
+      node* next = current->next;
+      if (pred(value_of(current))) {
+        removed.splice(removed.end(), *this, const_iterator(current), const_iterator(next), 1);
+      }
+      current = next;
+    }
+    return removed.size();
+  }
+
+  // O(n), basic
+  size_t remove(const T& value) {
+    return remove_if([&value](const T& element) { return element == value; });
+  }
+
+  // O(n), nothrow
+  void reverse() noexcept {
+    node* current = &_root;
+    do {
+      std::swap(current->prev, current->next);
+      current = current->prev;
+    } while (current != &_root);
   }
 
   // O(1), nothrow
+  // the allocators are exchanged if they propagate on swap, otherwise they should be equal
   friend void swap(list& left, list& right) noexcept {
-    node* lp = left._root.prev;
-    node* ln = left._root.next;
-    node* rp = right._root.prev;
-    node* rn = right._root.next;
-    ln->prev = lp->next = &right._root;
-    rn->prev = rp->next = &left._root;
-    std::swap(left._root, right._root);
-    std::swap(left._size, right._size);
+    if constexpr (node_traits::propagate_on_container_swap::value) {
+      using std::swap;
+      swap(left._alloc, right._alloc);
+    } else {
+      assert(left.get_allocator() == right.get_allocator() && "Swap of lists with different allocators");
+    }
+    left.swap_nodes(right);
   }
 };
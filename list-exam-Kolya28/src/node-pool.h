@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+
+// Pool of small blocks for the nodes of linked containers. Blocks are carved from contiguous chunks of growing size
+// and freed blocks go to the free list of their size, so the nodes of containers churning their elements are reused
+// from the same few chunks instead of being scattered over the heap. Larger blocks go to operator new directly.
+// The chunks are released by the destructor only, so the pool should outlive the containers using it. Not
+// thread-safe.
+class node_pool {
+private:
+  static constexpr size_t GRANULARITY = alignof(std::max_align_t);
+  static constexpr size_t MAX_POOLED_SIZE = 256;
+  static constexpr size_t MAX_CHUNK_SIZE = size_t(1) << 20;
+
+  static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ >= GRANULARITY);
+
+  struct free_block {
+    free_block* next;
+  };
+
+  // header of a chunk, padded to keep the blocks after it aligned
+  struct alignas(GRANULARITY) chunk {
+    chunk* prev;
+  };
+
+  free_block* _free_lists[MAX_POOLED_SIZE / GRANULARITY] = {};
+  chunk* _chunks = nullptr;
+  std::byte* _current = nullptr;
+  std::byte* _end = nullptr;
+  size_t _next_chunk_size;
+
+  static size_t size_class(size_t bytes) noexcept {
+    return bytes == 0 ? 0 : (bytes - 1) / GRANULARITY;
+  }
+
+  static bool is_pooled(size_t bytes, size_t alignment) noexcept {
+    return bytes <= MAX_POOLED_SIZE && alignment <= GRANULARITY;
+  }
+
+  void add_chunk() {
+    size_t size = _next_chunk_size;
+    _chunks = new (operator new(sizeof(chunk) + size)) chunk{_chunks};
+    _current = reinterpret_cast<std::byte*>(_chunks + 1);
+    _end = _current + size;
+    _next_chunk_size = std::min(size * 2, MAX_CHUNK_SIZE);
+  }
+
+public:
+  explicit node_pool(size_t initial_chunk_size = 4096) noexcept
+      : _next_chunk_size(std::max(initial_chunk_size, MAX_POOLED_SIZE)) {}
+
+  node_pool(const node_pool&) = delete;
+  node_pool& operator=(const node_pool&) = delete;
+
+  ~node_pool() noexcept {
+    while (_chunks != nullptr) {
+      chunk* prev = _chunks->prev;
+      operator delete(_chunks);
+      _chunks = prev;
+    }
+  }
+
+  // O(1) amortized, strong
+  void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+    if (!is_pooled(bytes, alignment)) {
+      return operator new(bytes, std::align_val_t(alignment));
+    }
+    free_block*& free_list = _free_lists[size_class(bytes)];
+    if (free_list != nullptr) {
+      free_block* block = free_list;
+      free_list = block->next;
+      return block;
+    }
+    size_t size = (size_class(bytes) + 1) * GRANULARITY;
+    if (static_cast<size_t>(_end - _current) < size) {
+      add_chunk();
+    }
+    void* result = _current;
+    _current += size;
+    return result;
+  }
+
+  // O(1), nothrow
+  void deallocate(void* p, size_t bytes, size_t alignment = alignof(std::max_align_t)) noexcept {
+    if (!is_pooled(bytes, alignment)) {
+      operator delete(p, std::align_val_t(alignment));
+      return;
+    }
+    free_block*& free_list = _free_lists[size_class(bytes)];
+    free_list = new (p) free_block{free_list};
+  }
+};
+
+// Allocator drawing the storage from a node_pool. It stays with a container on copy, move and swap, so only the
+// containers of one pool may exchange nodes, for example by splice.
+template <typename T>
+class pool_allocator {
+public:
+  using value_type = T;
+
+  pool_allocator(node_pool& pool) noexcept : _pool(&pool) {}
+
+  template <typename U>
+  pool_allocator(const pool_allocator<U>& other) noexcept : _pool(other.get_pool()) {}
+
+  T* allocate(size_t n) {
+    if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(_pool->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    _pool->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  node_pool* get_pool() const noexcept {
+    return _pool;
+  }
+
+  template <typename U>
+  friend bool operator==(const pool_allocator& left, const pool_allocator<U>& right) noexcept {
+    return left.get_pool() == right.get_pool();
+  }
+
+private:
+  node_pool* _pool;
+};
@@ -0,0 +1,459 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Doubly linked list of chunks holding up to CHUNK_CAPACITY elements each. Iteration walks contiguous elements and
+// follows a pointer once per chunk, so scans run close to vector speed, while insertion and erasure near an
+// iterator move at most CHUNK_CAPACITY elements. Unlike list, insertion and erasure invalidate the iterators to
+// the elements of the chunks they change, end() stays valid.
+template <typename T, size_t CHUNK_CAPACITY = std::max<size_t>(8, 512 / sizeof(T))>
+class unrolled_list {
+  static_assert(CHUNK_CAPACITY >= 2, "Chunks should hold at least two elements");
+
+public:
+  using value_type = T;
+
+  using reference = T&;
+  using const_reference = const T&;
+
+  using pointer = T*;
+  using const_pointer = const T*;
+
+private:
+  struct node {
+    void link_next(node* other) noexcept {
+      next = other;
+      other->prev = this;
+    }
+
+    node* prev;
+    node* next;
+    size_t count = 0;
+  };
+
+  struct chunk : node {
+    T* data() noexcept {
+      return reinterpret_cast<T*>(storage);
+    }
+
+    alignas(T) std::byte storage[sizeof(T) * CHUNK_CAPACITY];
+  };
+
+  static T* elements(node* n) noexcept {
+    return static_cast<chunk*>(n)->data();
+  }
+
+  template <class U>
+  class basic_iterator {
+    friend unrolled_list;
+
+    template <class>
+    friend class basic_iterator;
+
+  public:
+    using value_type = T;
+    using reference = U&;
+    using pointer = U*;
+    using difference_type = ptrdiff_t;
+    using iterator_category = std::bidirectional_iterator_tag;
+
+  private:
+    node* _node;
+    size_t _index;
+
+    basic_iterator(node* node, size_t index) noexcept : _node(node), _index(index) {}
+
+  public:
+    basic_iterator() noexcept = default;
+
+    operator basic_iterator<const U>() const noexcept {
+      return basic_iterator<const U>(_node, _index);
+    }
+
+    basic_iterator& operator++() noexcept {
+      if (++_index == _node->count) {
+        _node = _node->next;
+        _index = 0;
+      }
+      return *this;
+    }
+
+    basic_iterator& operator--() noexcept {
+      if (_index == 0) {
+        _node = _node->prev;
+        _index = _node->count;
+      }
+      --_index;
+      return *this;
+    }
+
+    basic_iterator operator++(int) noexcept {
+      basic_iterator copy(*this);
+      ++*this;
+      return copy;
+    }
+
+    basic_iterator operator--(int) noexcept {
+      basic_iterator copy(*this);
+      --*this;
+      return copy;
+    }
+
+    reference operator*() const noexcept {
+      return elements(_node)[_index];
+    }
+
+    pointer operator->() const noexcept {
+      return elements(_node) + _index;
+    }
+
+    friend bool operator==(const basic_iterator& left, const basic_iterator& right) noexcept = default;
+  };
+
+  size_t _size;
+  node _root;
+
+  // Constructs count elements at out from the ones at first, moving them if that can't throw and copying
+  // otherwise, so on exception the source is unchanged.
+  static void uninitialized_relocate(T* first, size_t count, T* out) {
+    if constexpr (std::is_nothrow_move_constructible_v<T>) {
+      std::uninitialized_move_n(first, count, out);
+    } else {
+      std::uninitialized_copy_n(first, count, out);
+    }
+  }
+
+  node* insert_chunk_after(node* pos) {
+    chunk* new_chunk = new chunk;
+    node* next = pos->next;
+    pos->link_next(new_chunk);
+    new_chunk->link_next(next);
+    return new_chunk;
+  }
+
+  void remove_chunk(node* old_chunk) noexcept {
+    old_chunk->prev->link_next(old_chunk->next);
+    delete static_cast<chunk*>(old_chunk);
+  }
+
+  // moves the upper half of a full chunk to a new chunk after it
+  void split(node* full) {
+    chunk* upper = new chunk;
+    size_t keep = full->count / 2;
+    size_t moved = full->count - keep;
+    try {
+      uninitialized_relocate(elements(full) + keep, moved, upper->data());
+    } catch (...) {
+      delete upper;
+      throw;
+    }
+    std::destroy_n(elements(full) + keep, moved);
+    full->count = keep;
+    upper->count = moved;
+    node* next = full->next;
+    full->link_next(upper);
+    upper->link_next(next);
+  }
+
+  // appends the elements of the chunk after left to it and removes that chunk, T should be nothrow movable
+  void merge_chunks(node* left) noexcept {
+    node* right = left->next;
+    std::uninitialized_move_n(elements(right), right->count, elements(left) + left->count);
+    std::destroy_n(elements(right), right->count);
+    left->count += right->count;
+    remove_chunk(right);
+  }
+
+  // merges the chunk of an erased element with a sparse neighbour to keep the chunks filled
+  basic_iterator<T> rebalance(node* target, size_t index) noexcept {
+    if constexpr (std::is_nothrow_move_constructible_v<T>) {
+      if (target == &_root) {
+        return end();
+      }
+      if (target->next != &_root && target->count + target->next->count <= CHUNK_CAPACITY / 2) {
+        merge_chunks(target);
+      }
+      if (target->prev != &_root && target->prev->count + target->count <= CHUNK_CAPACITY / 2) {
+        target = target->prev;
+        index += target->count;
+        merge_chunks(target);
+      }
+    }
+    return basic_iterator<T>(target, index);
+  }
+
+  // constructs an element at index of a chunk with room, removing the chunk if that throws and it is new
+  template <typename... Args>
+  basic_iterator<T> emplace_into(node* target, size_t index, bool new_chunk, Args&&... args) {
+    T* data = elements(target);
+    if (index == target->count) {
+      try {
+        new (data + index) T(std::forward<Args>(args)...);
+      } catch (...) {
+        if (new_chunk) {
+          remove_chunk(target);
+        }
+        throw;
+      }
+      ++target->count;
+      ++_size;
+    } else {
+      T value(std::forward<Args>(args)...);
+      new (data + target->count) T(std::move_if_noexcept(data[target->count - 1]));
+      ++target->count;
+      ++_size;
+      std::move_backward(data + index, data + target->count - 2, data + target->count - 1);
+      data[index] = std::move(value);
+    }
+    return basic_iterator<T>(target, index);
+  }
+
+public:
+  using iterator = basic_iterator<value_type>;
+  using const_iterator = basic_iterator<const value_type>;
+
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+public:
+  // O(1), nothrow
+  unrolled_list() noexcept : _size(0), _root{&_root, &_root, 0} {}
+
+  // O(n), strong
+  unrolled_list(const unrolled_list& other) : unrolled_list(other.begin(), other.end()) {}
+
+  // O(1), nothrow
+  unrolled_list(unrolled_list&& other) noexcept : unrolled_list() {
+    swap(*this, other);
+  }
+
+  // O(n), strong
+  template <std::input_iterator InputIt>
+  unrolled_list(InputIt first, InputIt last) : unrolled_list() {
+    std::copy(first, last, std::back_inserter(*this));
+  }
+
+  // O(n), strong
+  unrolled_list& operator=(const unrolled_list& other) {
+    if (&other != this) {
+      unrolled_list copy = other;
+      swap(*this, copy);
+    }
+    return *this;
+  }
+
+  // O(n), nothrow
+  unrolled_list& operator=(unrolled_list&& other) noexcept {
+    if (&other != this) {
+      clear();
+      swap(*this, other);
+    }
+    return *this;
+  }
+
+  // O(n), nothrow
+  ~unrolled_list() noexcept {
+    clear();
+  }
+
+  // O(1), nothrow
+  bool empty() const noexcept {
+    return _size == 0;
+  }
+
+  // O(1), nothrow
+  size_t size() const noexcept {
+    return _size;
+  }
+
+  // O(1), nothrow
+  T& front() noexcept {
+    return *begin();
+  }
+
+  // O(1), nothrow
+  const T& front() const noexcept {
+    return *begin();
+  }
+
+  // O(1), nothrow
+  T& back() noexcept {
+    return *std::prev(end());
+  }
+
+  // O(1), nothrow
+  const T& back() const noexcept {
+    return *std::prev(end());
+  }
+
+  // O(CHUNK_CAPACITY), basic
+  void push_front(const T& val) {
+    emplace(begin(), val);
+  }
+
+  // O(CHUNK_CAPACITY), basic
+  void push_front(T&& val) {
+    emplace(begin(), std::move(val));
+  }
+
+  // O(1), strong
+  void push_back(const T& val) {
+    emplace(end(), val);
+  }
+
+  // O(1), strong
+  void push_back(T&& val) {
+    emplace(end(), std::move(val));
+  }
+
+  // O(1), strong
+  template <typename... Args>
+  T& emplace_back(Args&&... args) {
+    return *emplace(end(), std::forward<Args>(args)...);
+  }
+
+  // O(CHUNK_CAPACITY), basic if the move assignment of T throws
+  void pop_front() noexcept(std::is_nothrow_move_assignable_v<T>) {
+    erase(begin());
+  }
+
+  // O(1), nothrow
+  void pop_back() noexcept(std::is_nothrow_move_assignable_v<T>) {
+    erase(std::prev(end()));
+  }
+
+  // O(1), nothrow
+  iterator begin() noexcept {
+    return iterator(_root.next, 0);
+  }
+
+  // O(1), nothrow
+  const_iterator begin() const noexcept {
+    return const_iterator(_root.next, 0);
+  }
+
+  // O(1), nothrow
+  iterator end() noexcept {
+    return iterator(&_root, 0);
+  }
+
+  // O(1), nothrow
+  const_iterator end() const noexcept {
+    return const_iterator(const_cast<node*>(&_root), 0);
+  }
+
+  // O(1), nothrow
+  reverse_iterator rbegin() noexcept {
+    return std::reverse_iterator(end());
+  }
+
+  // O(1), nothrow
+  const_reverse_iterator rbegin() const noexcept {
+    return std::reverse_iterator(end());
+  }
+
+  // O(1), nothrow
+  reverse_iterator rend() noexcept {
+    return std::reverse_iterator(begin());
+  }
+
+  // O(1), nothrow
+  const_reverse_iterator rend() const noexcept {
+    return std::reverse_iterator(begin());
+  }
+
+  // O(n), nothrow
+  void clear() noexcept {
+    while (_root.next != &_root) {
+      std::destroy_n(elements(_root.next), _root.next->count);
+      remove_chunk(_root.next);
+    }
+    _size = 0;
+  }
+
+  // O(CHUNK_CAPACITY), strong if the element is appended to a chunk with room, basic otherwise
+  iterator insert(const_iterator pos, const T& val) {
+    return emplace(pos, val);
+  }
+
+  // O(CHUNK_CAPACITY), strong if the element is appended to a chunk with room, basic otherwise
+  iterator insert(const_iterator pos, T&& val) {
+    return emplace(pos, std::move(val));
+  }
+
+  // O(CHUNK_CAPACITY), strong if the element is appended to a chunk with room, basic otherwise
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
+    node* target = pos._node;
+    size_t index = pos._index;
+    bool new_chunk = false;
+    if (index == 0 && target->prev != &_root && target->prev->count < CHUNK_CAPACITY) {
+      // appending to the previous chunk moves nothing
+      target = target->prev;
+      index = target->count;
+    } else if (target == &_root) {
+      target = insert_chunk_after(_root.prev);
+      new_chunk = true;
+    } else if (target->count == CHUNK_CAPACITY) {
+      // args may refer to an element the split moves
+      T value(std::forward<Args>(args)...);
+      split(target);
+      if (index > target->count) {
+        index -= target->count;
+        target = target->next;
+      }
+      return emplace_into(target, index, false, std::move(value));
+    }
+    return emplace_into(target, index, new_chunk, std::forward<Args>(args)...);
+  }
+
+  // O(CHUNK_CAPACITY), basic if the move assignment of T throws
+  iterator erase(const_iterator pos) noexcept(std::is_nothrow_move_assignable_v<T>) {
+    return erase(pos, std::next(pos));
+  }
+
+  // O(last - first + CHUNK_CAPACITY), basic if the move assignment of T throws
+  iterator erase(const_iterator first, const_iterator last) noexcept(std::is_nothrow_move_assignable_v<T>) {
+    size_t count = std::distance(first, last);
+    if (count == 0) {
+      return iterator(first._node, first._index);
+    }
+    node* target = first._node;
+    size_t index = first._index;
+    while (count != 0) {
+      T* data = elements(target);
+      size_t erased = std::min(count, target->count - index);
+      std::move(data + index + erased, data + target->count, data + index);
+      std::destroy(data + target->count - erased, data + target->count);
+      target->count -= erased;
+      _size -= erased;
+      count -= erased;
+      if (index == target->count) {
+        node* next = target->next;
+        if (target->count == 0) {
+          remove_chunk(target);
+        }
+        target = next;
+        index = 0;
+      }
+    }
+    return rebalance(target, index);
+  }
+
+  // O(1), nothrow
+  friend void swap(unrolled_list& left, unrolled_list& right) noexcept {
+    node* lp = left._root.prev;
+    node* ln = left._root.next;
+    node* rp = right._root.prev;
+    node* rn = right._root.next;
+    ln->prev = lp->next = &right._root;
+    rn->prev = rp->next = &left._root;
+    std::swap(left._root, right._root);
+    std::swap(left._size, right._size);
+  }
+};
@@ -1,10 +1,19 @@
 #include "element.h"
 #include "fault-injection.h"
 #include "list.h"
+#include "node-pool.h"
 #include "test-utils.h"
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
 static_assert(!std::constructible_from<container::iterator, std::nullptr_t>,
               "iterator should not be constructible from nullptr");
 static_assert(!std::constructible_from<container::const_iterator, std::nullptr_t>,
@@ -26,6 +35,56 @@ class exception_safety_test : public base_test {};
 
 class performance_test : public base_test {};
 
+class allocator_test : public base_test {};
+
+using pool_container = list<element, pool_allocator<element>>;
+
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  counting_allocator(size_t& allocations) noexcept : allocations(&allocations) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U>& other) noexcept : allocations(other.allocations) {}
+
+  T* allocate(size_t n) {
+    ++*allocations;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    --*allocations;
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U>
+  friend bool operator==(const counting_allocator& left, const counting_allocator<U>& right) noexcept {
+    return left.allocations == right.allocations;
+  }
+
+  size_t* allocations;
+};
+
+struct move_counting {
+  move_counting(int value) : value(value) {}
+
+  move_counting(int value, int other) : value(value + other) {}
+
+  move_counting(const move_counting& other) : value(other.value) {
+    ++copies;
+  }
+
+  move_counting(move_counting&& other) noexcept : value(other.value) {
+    ++moves;
+  }
+
+  int value;
+
+  inline static size_t copies = 0;
+  inline static size_t moves = 0;
+};
+
 struct non_default_constructible {
   non_default_constructible() = delete;
 };
@@ -1067,6 +1126,515 @@ TEST_F(exception_safety_test, copy_assignment) {
   });
 }
 
+TEST_F(exception_safety_test, push_back_pool) {
+  faulty_run([] {
+    node_pool pool(sizeof(element) * 8);
+    pool_container c(pool);
+
+    auto range = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    for (int e : range) {
+      strong_exception_safety_guard sg(c);
+      c.push_back(e);
+    }
+    expect_eq(c, range);
+  });
+}
+
+TEST_F(allocator_test, counting) {
+  size_t allocations = 0;
+  {
+    list<element, counting_allocator<element>> c(allocations);
+    expect_empty(c);
+    EXPECT_EQ(0, allocations);
+
+    mass_push_back(c, {1, 2, 3, 4});
+    EXPECT_EQ(4, allocations);
+
+    auto copy = c;
+    EXPECT_EQ(8, allocations);
+    EXPECT_TRUE(copy.get_allocator() == c.get_allocator());
+
+    c.erase(std::next(c.begin()), std::prev(c.end()));
+    expect_eq(c, {1, 4});
+    EXPECT_EQ(6, allocations);
+  }
+  EXPECT_EQ(0, allocations);
+}
+
+TEST_F(allocator_test, pool) {
+  node_pool pool;
+  pool_container c(pool);
+  pool_container other(pool);
+  mass_push_back(c, {1, 2, 3, 4});
+  mass_push_back(other, {5, 6});
+
+  other.splice(other.end(), c, std::next(c.begin()), c.end());
+  expect_eq(c, {1});
+  expect_eq(other, {5, 6, 2, 3, 4});
+
+  swap(c, other);
+  expect_eq(c, {5, 6, 2, 3, 4});
+  expect_eq(other, {1});
+
+  pool_container copy = c;
+  EXPECT_EQ(&pool, copy.get_allocator().get_pool());
+  expect_eq(copy, {5, 6, 2, 3, 4});
+
+  other = copy;
+  EXPECT_EQ(&pool, other.get_allocator().get_pool());
+  expect_eq(other, {5, 6, 2, 3, 4});
+}
+
+TEST_F(allocator_test, pool_contiguous) {
+  node_pool pool;
+  pool_container c(pool);
+  mass_push_back(c, {1, 2, 3, 4, 5, 6, 7, 8});
+
+  std::vector<const element*> addresses;
+  for (const element& e : c) {
+    addresses.push_back(&e);
+  }
+  for (size_t i = 1; i < addresses.size(); ++i) {
+    EXPECT_TRUE(std::greater<>()(addresses[i], addresses[i - 1]));
+    EXPECT_EQ(addresses[1] - addresses[0], addresses[i] - addresses[i - 1]);
+  }
+}
+
+TEST_F(allocator_test, pool_reuse) {
+  node_pool pool;
+  pool_container c(pool);
+  mass_push_back(c, {1, 2, 3, 4});
+
+  const element* second = &*std::next(c.begin());
+  c.erase(std::next(c.begin()));
+  c.push_front(5);
+  EXPECT_EQ(second, &c.front());
+  expect_eq(c, {5, 1, 3, 4});
+}
+
+TEST_F(allocator_test, pool_large_blocks) {
+  node_pool pool;
+  void* small = pool.allocate(16);
+  void* large = pool.allocate(4096);
+  void* aligned = pool.allocate(64, 256);
+  EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(aligned) % 256);
+  pool.deallocate(aligned, 64, 256);
+  pool.deallocate(large, 4096);
+  pool.deallocate(small, 16);
+  EXPECT_EQ(small, pool.allocate(16));
+}
+
+TEST_F(correctness_test, push_back_rvalue) {
+  list<move_counting> c;
+  move_counting::copies = move_counting::moves = 0;
+
+  move_counting value(1);
+  c.push_back(std::move(value));
+  c.push_front(move_counting(2));
+  c.insert(std::next(c.begin()), move_counting(3));
+  EXPECT_EQ(0, move_counting::copies);
+  EXPECT_EQ(3, move_counting::moves);
+
+  c.push_back(value);
+  EXPECT_EQ(1, move_counting::copies);
+}
+
+TEST_F(correctness_test, emplace) {
+  list<move_counting> c;
+  move_counting::copies = move_counting::moves = 0;
+
+  move_counting& back = c.emplace_back(1, 2);
+  EXPECT_EQ(3, back.value);
+  move_counting& front = c.emplace_front(4);
+  EXPECT_EQ(4, front.value);
+  auto it = c.emplace(std::next(c.begin()), 5, 6);
+  EXPECT_EQ(11, it->value);
+  EXPECT_EQ(std::next(c.begin()), it);
+  EXPECT_EQ(0, move_counting::copies);
+  EXPECT_EQ(0, move_counting::moves);
+
+  EXPECT_EQ(&front, &c.front());
+  EXPECT_EQ(&back, &c.back());
+}
+
+TEST_F(correctness_test, move_only) {
+  list<std::unique_ptr<int>> c;
+  c.push_back(std::make_unique<int>(1));
+  c.emplace_front(new int(2));
+  EXPECT_EQ(2, *c.front());
+  EXPECT_EQ(1, *c.back());
+}
+
+TEST_F(correctness_test, move_ctor) {
+  container c;
+  mass_push_back(c, {1, 2, 3, 4});
+  const element* first = &c.front();
+
+  container c2 = std::move(c);
+  expect_eq(c2, {1, 2, 3, 4});
+  EXPECT_EQ(first, &c2.front());
+  expect_empty(c);
+
+  container c3 = std::move(c);
+  expect_empty(c3);
+}
+
+TEST_F(correctness_test, move_assignment) {
+  container c;
+  mass_push_back(c, {1, 2, 3, 4});
+  const element* first = &c.front();
+
+  container c2;
+  mass_push_back(c2, {5, 6});
+  c2 = std::move(c);
+  expect_eq(c2, {1, 2, 3, 4});
+  EXPECT_EQ(first, &c2.front());
+
+  c2 = std::move(c2);
+  expect_eq(c2, {1, 2, 3, 4});
+}
+
+TEST_F(allocator_test, move_assignment_other_pool) {
+  node_pool pool1;
+  node_pool pool2;
+  pool_container c(pool1);
+  mass_push_back(c, {1, 2, 3});
+
+  pool_container c2(pool2);
+  c2 = std::move(c);
+  expect_eq(c2, {1, 2, 3});
+  EXPECT_EQ(&pool2, c2.get_allocator().get_pool());
+}
+
+TEST_F(allocator_test, memory_resource) {
+  alignas(std::max_align_t) std::byte buffer1[1 << 12];
+  alignas(std::max_align_t) std::byte buffer2[1 << 12];
+  std::pmr::monotonic_buffer_resource resource1(buffer1, sizeof(buffer1), std::pmr::null_memory_resource());
+  std::pmr::monotonic_buffer_resource resource2(buffer2, sizeof(buffer2), std::pmr::null_memory_resource());
+  auto inside = [](const void* p, const std::byte* buffer) {
+    return std::less_equal<const void*>()(buffer, p) && std::less<const void*>()(p, buffer + (1 << 12));
+  };
+  using pmr_list = list<int, std::pmr::polymorphic_allocator<int>>;
+
+  pmr_list a(&resource1);
+  mass_push_back(a, {1, 2, 3});
+  pmr_list b(&resource2);
+  b.push_back(4);
+
+  // polymorphic_allocator doesn't propagate, so the copy is allocated from the resource of b
+  b = a;
+  expect_eq(b, {1, 2, 3});
+  EXPECT_EQ(&resource2, b.get_allocator().resource());
+  EXPECT_TRUE(inside(&b.front(), buffer2));
+  EXPECT_TRUE(inside(&a.front(), buffer1));
+
+  b = std::move(a);
+  expect_eq(b, {1, 2, 3});
+  EXPECT_EQ(&resource2, b.get_allocator().resource());
+  EXPECT_TRUE(inside(&b.back(), buffer2));
+
+  pmr_list::node_type handle = b.extract(b.begin());
+  pmr_list::node_type other;
+  other = std::move(handle);
+  EXPECT_EQ(1, other.value());
+  EXPECT_EQ(&resource2, other.get_allocator().resource());
+}
+
+TEST_F(correctness_test, extract) {
+  container c;
+  mass_push_back(c, {1, 2, 3, 4});
+  const element* second = &*std::next(c.begin());
+
+  container::node_type handle = c.extract(std::next(c.begin()));
+  expect_eq(c, {1, 3, 4});
+  ASSERT_FALSE(handle.empty());
+  EXPECT_EQ(2, handle.value());
+  EXPECT_EQ(second, &handle.value());
+}
+
+TEST_F(correctness_test, extract_insert) {
+  container c;
+  mass_push_back(c, {1, 2, 3, 4});
+  const element* third = &*std::next(c.begin(), 2);
+
+  auto it = c.insert(c.begin(), c.extract(std::next(c.begin(), 2)));
+  expect_eq(c, {3, 1, 2, 4});
+  EXPECT_EQ(c.begin(), it);
+  EXPECT_EQ(third, &c.front());
+
+  container::node_type handle;
+  EXPECT_FALSE(handle);
+  EXPECT_EQ(c.end(), c.insert(c.end(), std::move(handle)));
+  expect_eq(c, {3, 1, 2, 4});
+}
+
+TEST_F(correctness_test, extract_between_lists) {
+  container c1;
+  container c2;
+  mass_push_back(c1, {1, 2, 3});
+  mass_push_back(c2, {4, 5});
+
+  container::node_type handle = c1.extract(c1.begin());
+  handle.value() = 42;
+  container::node_type other = std::move(handle);
+  EXPECT_TRUE(handle.empty());
+  c2.insert(std::next(c2.begin()), std::move(other));
+  EXPECT_TRUE(other.empty());
+  expect_eq(c1, {2, 3});
+  expect_eq(c2, {4, 42, 5});
+}
+
+TEST_F(allocator_test, extract_insert_no_allocation) {
+  size_t allocations = 0;
+  list<element, counting_allocator<element>> c(allocations);
+  mass_push_back(c, {1, 2, 3, 4});
+
+  for (size_t i = 0; i < 10; ++i) {
+    c.insert(c.begin(), c.extract(std::prev(c.end())));
+  }
+  expect_eq(c, {3, 4, 1, 2});
+  EXPECT_EQ(4, allocations);
+
+  c.extract(c.begin());
+  EXPECT_EQ(3, allocations);
+}
+
+TEST_F(exception_safety_test, emplace) {
+  faulty_run([] {
+    container c;
+    mass_push_back(c, {1, 2, 3});
+    strong_exception_safety_guard sg(c);
+    element e(4);
+    c.emplace(std::next(c.begin()), e);
+    expect_eq(c, {1, 4, 2, 3});
+  });
+}
+
+TEST_F(correctness_test, splice_count) {
+  container c1;
+  container c2;
+  mass_push_back(c1, {1, 2, 3, 4, 5});
+  mass_push_back(c2, {6, 7});
+
+  c2.splice(std::next(c2.begin()), c1, std::next(c1.begin()), std::prev(c1.end()), 3);
+  expect_eq(c1, {1, 5});
+  expect_eq(c2, {6, 2, 3, 4, 7});
+
+  c2.splice(c2.begin(), c2, std::next(c2.begin(), 3), c2.end(), 2);
+  expect_eq(c2, {4, 7, 6, 2, 3});
+}
+
+TEST_F(correctness_test, lazy_size) {
+  list<element, std::allocator<element>, list_lazy_size> c1;
+  list<element, std::allocator<element>, list_lazy_size> c2;
+  mass_push_back(c1, {1, 2, 3, 4, 5});
+  mass_push_back(c2, {6, 7});
+
+  c2.splice(c2.end(), c1, std::next(c1.begin()), std::prev(c1.end()));
+  expect_eq(c1, {1, 5});
+  expect_eq(c2, {6, 7, 2, 3, 4});
+
+  c2.push_back(8);
+  c2.erase(c2.begin());
+  expect_eq(c2, {7, 2, 3, 4, 8});
+
+  c1.splice(c1.end(), c2, std::next(c2.begin()), c2.end());
+  c2.splice(c2.begin(), c1, c1.begin(), c1.end());
+  expect_eq(c1, {});
+  expect_eq(c2, {1, 5, 2, 3, 4, 8, 7});
+
+  auto c3 = c2;
+  expect_eq(c3, {1, 5, 2, 3, 4, 8, 7});
+  c3.clear();
+  expect_empty(c3);
+}
+
+TEST_F(correctness_test, erase_range_count) {
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5, 6});
+  auto it = c.erase(std::next(c.begin()), std::prev(c.end(), 2));
+  EXPECT_EQ(5, *it);
+  expect_eq(c, {1, 5, 6});
+  c.erase(c.begin(), c.end());
+  expect_empty(c);
+}
+
+TEST_F(correctness_test, sort) {
+  container c;
+  mass_push_back(c, {5, 3, 8, 1, 9, 2, 7, 4, 6, 0, 3});
+  c.sort();
+  expect_eq(c, {0, 1, 2, 3, 3, 4, 5, 6, 7, 8, 9});
+
+  c.sort(std::greater<>());
+  expect_eq(c, {9, 8, 7, 6, 5, 4, 3, 3, 2, 1, 0});
+  expect_eq(reverse_view(c), {0, 1, 2, 3, 3, 4, 5, 6, 7, 8, 9});
+}
+
+TEST_F(correctness_test, sort_small) {
+  container c;
+  c.sort();
+  expect_empty(c);
+
+  c.push_back(1);
+  c.sort();
+  expect_eq(c, {1});
+
+  c.push_front(2);
+  c.sort();
+  expect_eq(c, {1, 2});
+}
+
+TEST_F(correctness_test, sort_stable) {
+  list<std::pair<int, int>> c;
+  for (int i = 0; i < 1000; ++i) {
+    c.emplace_back((i * 7919) % 13, i);
+  }
+  c.sort([](const auto& a, const auto& b) { return a.first < b.first; });
+
+  auto prev = c.begin();
+  for (auto it = std::next(prev); it != c.end(); prev = it++) {
+    ASSERT_TRUE(prev->first < it->first || (prev->first == it->first && prev->second < it->second));
+  }
+  EXPECT_EQ(1000, c.size());
+}
+
+TEST_F(correctness_test, sort_keeps_nodes) {
+  container c;
+  mass_push_back(c, {3, 1, 2});
+  const element* one = &*std::next(c.begin());
+  c.sort();
+  EXPECT_EQ(one, &c.front());
+}
+
+TEST_F(correctness_test, merge) {
+  container c1;
+  container c2;
+  mass_push_back(c1, {1, 3, 5, 7});
+  mass_push_back(c2, {0, 2, 3, 8, 9});
+  const element* three = &*std::next(c2.begin(), 2);
+
+  c1.merge(c2);
+  expect_eq(c1, {0, 1, 2, 3, 3, 5, 7, 8, 9});
+  expect_empty(c2);
+  EXPECT_EQ(three, &*std::next(c1.begin(), 4));
+
+  c1.merge(c1);
+  expect_eq(c1, {0, 1, 2, 3, 3, 5, 7, 8, 9});
+
+  c1.merge(c2);
+  expect_eq(c1, {0, 1, 2, 3, 3, 5, 7, 8, 9});
+  c2.merge(c1);
+  expect_eq(c2, {0, 1, 2, 3, 3, 5, 7, 8, 9});
+  expect_empty(c1);
+}
+
+TEST_F(correctness_test, merge_compare) {
+  container c1;
+  container c2;
+  mass_push_back(c1, {9, 4, 1});
+  mass_push_back(c2, {8, 4, 2});
+  c1.merge(c2, std::greater<>());
+  expect_eq(c1, {9, 8, 4, 4, 2, 1});
+}
+
+TEST_F(correctness_test, unique) {
+  container c;
+  mass_push_back(c, {1, 1, 2, 3, 3, 3, 1, 4, 4});
+  EXPECT_EQ(4, c.unique());
+  expect_eq(c, {1, 2, 3, 1, 4});
+
+  EXPECT_EQ(1, c.unique([](int a, int b) { return b == a + 1; }));
+  expect_eq(c, {1, 3, 1, 4});
+
+  container e;
+  EXPECT_EQ(0, e.unique());
+}
+
+TEST_F(correctness_test, remove_if) {
+  container c;
+  mass_push_back(c, {1, 2, 3, 4, 5, 6, 7});
+  EXPECT_EQ(3, c.remove_if([](int a) { return a % 2 == 0; }));
+  expect_eq(c, {1, 3, 5, 7});
+}
+
+TEST_F(correctness_test, remove_own_element) {
+  container c;
+  mass_push_back(c, {1, 2, 1, 3, 1});
+  EXPECT_EQ(3, c.remove(*std::next(c.begin(), 2)));
+  expect_eq(c, {2, 3});
+}
+
+TEST_F(correctness_test, reverse) {
+  container c;
+  c.reverse();
+  expect_empty(c);
+
+  mass_push_back(c, {1, 2, 3, 4});
+  c.reverse();
+  expect_eq(c, {4, 3, 2, 1});
+  expect_eq(reverse_view(c), {1, 2, 3, 4});
+  c.push_back(0);
+  c.push_front(5);
+  expect_eq(c, {5, 4, 3, 2, 1, 0});
+}
+
+TEST_F(allocator_test, algorithms_no_allocation) {
+  size_t allocations = 0;
+  list<int, counting_allocator<int>> c1(allocations);
+  list<int, counting_allocator<int>> c2(allocations);
+  for (int i = 0; i < 100; ++i) {
+    c1.push_back((i * 37) % 100);
+    c2.push_back(i);
+  }
+  EXPECT_EQ(200, allocations);
+
+  c1.sort();
+  c1.merge(c2);
+  c1.reverse();
+  EXPECT_EQ(200, allocations);
+  EXPECT_EQ(100, c1.unique());
+  EXPECT_EQ(100, allocations);
+}
+
+TEST_F(exception_safety_test, sort) {
+  faulty_run([] {
+    container c;
+    mass_push_back(c, {6, 2, 7, 1, 3, 5, 4, 0});
+    try {
+      c.sort();
+    } catch (...) {
+      fault_injection_disable dg;
+      EXPECT_EQ(8, c.size());
+      EXPECT_EQ(8, std::distance(c.begin(), c.end()));
+      EXPECT_EQ(8, std::distance(c.rbegin(), c.rend()));
+      c.sort();
+      expect_eq(c, {0, 1, 2, 3, 4, 5, 6, 7});
+      throw;
+    }
+    expect_eq(c, {0, 1, 2, 3, 4, 5, 6, 7});
+  });
+}
+
+TEST_F(exception_safety_test, merge) {
+  faulty_run([] {
+    container c1;
+    container c2;
+    mass_push_back(c1, {1, 3, 5});
+    mass_push_back(c2, {0, 2, 4, 6});
+    try {
+      c1.merge(c2);
+    } catch (...) {
+      fault_injection_disable dg;
+      EXPECT_EQ(7, c1.size() + c2.size());
+      EXPECT_EQ(c1.size(), std::distance(c1.begin(), c1.end()));
+      EXPECT_EQ(c2.size(), std::distance(c2.begin(), c2.end()));
+      throw;
+    }
+    expect_eq(c1, {0, 1, 2, 3, 4, 5, 6});
+    expect_empty(c2);
+  });
+}
+
 TEST_F(performance_test, size) {
   constexpr size_t N = 100'000;
   constexpr size_t K = 1'000'000;
@@ -1134,3 +1702,58 @@ TEST_F(performance_test, swap) {
     swap(c1, c2);
   }
 }
+
+TEST_F(performance_test, splice_range_count) {
+  constexpr size_t N = 100'000;
+  constexpr size_t K = 100'000;
+
+  container c1;
+  container c2;
+
+  for (size_t i = 0; i < N; ++i) {
+    c1.push_back(i);
+  }
+  c2.push_back(N);
+
+  for (size_t i = 0; i < K; ++i) {
+    container& from = (i % 2 == 0) ? c1 : c2;
+    container& to = (i % 2 == 0) ? c2 : c1;
+    to.splice(to.begin(), from, std::next(from.begin()), from.end(), N - 1);
+  }
+  EXPECT_EQ(N, c1.size());
+  EXPECT_EQ(1, c2.size());
+}
+
+TEST_F(performance_test, splice_range_lazy) {
+  constexpr size_t N = 100'000;
+  constexpr size_t K = 100'000;
+
+  using lazy_container = list<element, std::allocator<element>, list_lazy_size>;
+  lazy_container c1;
+  lazy_container c2;
+
+  for (size_t i = 0; i < N; ++i) {
+    c1.push_back(i);
+  }
+  c2.push_back(N);
+
+  for (size_t i = 0; i < K; ++i) {
+    lazy_container& from = (i % 2 == 0) ? c1 : c2;
+    lazy_container& to = (i % 2 == 0) ? c2 : c1;
+    to.splice(to.begin(), from, std::next(from.begin()), from.end());
+  }
+  EXPECT_EQ(N, c1.size());
+  EXPECT_EQ(1, c2.size());
+}
+
+TEST_F(performance_test, sort) {
+  constexpr size_t N = 300'000;
+
+  list<int> c;
+  for (size_t i = 0; i < N; ++i) {
+    c.push_back(static_cast<int>((i * 2'654'435'761) % N));
+  }
+  c.sort();
+  EXPECT_TRUE(std::is_sorted(c.begin(), c.end()));
+  EXPECT_EQ(N, c.size());
+}
@@ -0,0 +1,233 @@
+#include "element.h"
+#include "fault-injection.h"
+#include "test-utils.h"
+#include "unrolled-list.h"
+
+#include <gtest/gtest.h>
+
+#include <list>
+#include <random>
+#include <string>
+
+template class unrolled_list<element, 4>;
+using unrolled_container = unrolled_list<element, 4>;
+
+static_assert(std::bidirectional_iterator<unrolled_container::iterator>);
+static_assert(std::bidirectional_iterator<unrolled_container::const_iterator>);
+static_assert(std::bidirectional_iterator<unrolled_container::reverse_iterator>);
+static_assert(!std::constructible_from<unrolled_container::iterator, std::nullptr_t>,
+              "iterator should not be constructible from nullptr");
+
+namespace {
+class unrolled_list_test : public base_test {};
+
+template <typename C>
+void expect_same(const C& actual, const std::list<int>& expected) {
+  ASSERT_EQ(expected.size(), actual.size());
+  EXPECT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+  EXPECT_TRUE(std::equal(actual.rbegin(), actual.rend(), expected.rbegin(), expected.rend()));
+}
+} // namespace
+
+TEST_F(unrolled_list_test, default_ctor) {
+  unrolled_container c;
+  expect_empty(c);
+}
+
+TEST_F(unrolled_list_test, push_back) {
+  unrolled_container c;
+  mass_push_back(c, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  expect_eq(c, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  expect_eq(reverse_view(c), {9, 8, 7, 6, 5, 4, 3, 2, 1});
+  EXPECT_EQ(1, c.front());
+  EXPECT_EQ(9, c.back());
+}
+
+TEST_F(unrolled_list_test, push_front) {
+  unrolled_container c;
+  mass_push_front(c, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  expect_eq(c, {9, 8, 7, 6, 5, 4, 3, 2, 1});
+}
+
+TEST_F(unrolled_list_test, pop) {
+  unrolled_container c;
+  mass_push_back(c, {1, 2, 3, 4, 5, 6, 7});
+  c.pop_back();
+  c.pop_front();
+  expect_eq(c, {2, 3, 4, 5, 6});
+  while (!c.empty()) {
+    c.pop_back();
+  }
+  expect_empty(c);
+}
+
+TEST_F(unrolled_list_test, insert_middle) {
+  unrolled_container c;
+  mass_push_back(c, {1, 2, 3, 4});
+  auto it = c.insert(std::next(c.begin(), 2), 42);
+  EXPECT_EQ(42, *it);
+  expect_eq(c, {1, 2, 42, 3, 4});
+
+  it = c.insert(std::next(c.begin()), 43);
+  EXPECT_EQ(43, *it);
+  EXPECT_EQ(2, *std::next(it));
+  expect_eq(c, {1, 43, 2, 42, 3, 4});
+
+  it = c.insert(c.end(), 44);
+  EXPECT_EQ(44, *it);
+  EXPECT_EQ(c.end(), std::next(it));
+  expect_eq(c, {1, 43, 2, 42, 3, 4, 44});
+}
+
+TEST_F(unrolled_list_test, erase) {
+  unrolled_container c;
+  mass_push_back(c, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  auto it = c.erase(std::next(c.begin(), 3));
+  EXPECT_EQ(5, *it);
+  expect_eq(c, {1, 2, 3, 5, 6, 7, 8, 9});
+
+  it = c.erase(std::prev(c.end()));
+  EXPECT_EQ(c.end(), it);
+  expect_eq(c, {1, 2, 3, 5, 6, 7, 8});
+}
+
+TEST_F(unrolled_list_test, erase_range) {
+  unrolled_container c;
+  mass_push_back(c, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+  auto it = c.erase(std::next(c.begin(), 2), std::next(c.begin(), 7));
+  EXPECT_EQ(8, *it);
+  expect_eq(c, {1, 2, 8, 9, 10});
+
+  it = c.erase(c.begin(), c.begin());
+  EXPECT_EQ(c.begin(), it);
+
+  it = c.erase(c.begin(), c.end());
+  EXPECT_EQ(c.end(), it);
+  expect_empty(c);
+}
+
+TEST_F(unrolled_list_test, iterator_conversions) {
+  unrolled_container c;
+  mass_push_back(c, {1, 2, 3});
+  unrolled_container::iterator i = std::next(c.begin());
+  unrolled_container::const_iterator ci = i;
+  EXPECT_TRUE(ci == i);
+  ++ci;
+  EXPECT_EQ(3, *ci);
+  --ci;
+  --ci;
+  EXPECT_EQ(1, *ci);
+}
+
+TEST_F(unrolled_list_test, copy_and_move) {
+  unrolled_container c;
+  mass_push_back(c, {1, 2, 3, 4, 5});
+
+  unrolled_container c2 = c;
+  expect_eq(c2, {1, 2, 3, 4, 5});
+
+  unrolled_container c3;
+  mass_push_back(c3, {6});
+  c3 = c;
+  expect_eq(c3, {1, 2, 3, 4, 5});
+
+  unrolled_container c4 = std::move(c2);
+  expect_eq(c4, {1, 2, 3, 4, 5});
+  expect_empty(c2);
+
+  c3 = std::move(c4);
+  expect_eq(c3, {1, 2, 3, 4, 5});
+  expect_empty(c4);
+
+  swap(c3, c4);
+  expect_empty(c3);
+  expect_eq(c4, {1, 2, 3, 4, 5});
+}
+
+TEST_F(unrolled_list_test, random_operations) {
+  std::mt19937 rng(42);
+  unrolled_list<int, 4> c;
+  std::list<int> expected;
+  for (int i = 0; i < 20'000; ++i) {
+    size_t position = expected.empty() ? 0 : rng() % (expected.size() + 1);
+    auto it = std::next(c.begin(), position);
+    auto expected_it = std::next(expected.begin(), position);
+    if (rng() % 5 < 3 || expected_it == expected.end()) {
+      it = c.insert(it, i);
+      expected_it = expected.insert(expected_it, i);
+    } else if (rng() % 2 == 0) {
+      it = c.erase(it);
+      expected_it = expected.erase(expected_it);
+    } else {
+      size_t count = rng() % (std::distance(expected_it, expected.end()) + 1);
+      it = c.erase(it, std::next(it, count));
+      expected_it = expected.erase(expected_it, std::next(expected_it, count));
+    }
+    ASSERT_EQ(std::distance(expected.begin(), expected_it), std::distance(c.begin(), it));
+    if (i % 1000 == 0) {
+      expect_same(c, expected);
+    }
+  }
+  expect_same(c, expected);
+}
+
+TEST_F(unrolled_list_test, strings) {
+  unrolled_list<std::string, 3> c;
+  for (int i = 0; i < 100; ++i) {
+    c.push_back(std::string(50, static_cast<char>('a' + i % 26)));
+  }
+  for (auto it = c.begin(); it != c.end();) {
+    it = (it->front() % 2 == 0) ? c.erase(it) : std::next(it);
+  }
+  EXPECT_EQ(50, c.size());
+  for (const std::string& s : c) {
+    EXPECT_EQ(1, s.front() % 2);
+  }
+}
+
+TEST_F(unrolled_list_test, insert_own_element_into_full_chunk) {
+  unrolled_list<std::string, 4> c;
+  for (const char* s : {"first", "second", "third", "fourth"}) {
+    c.push_back(std::string(40, s[0]) + s);
+  }
+  c.push_front(c.back());
+  EXPECT_EQ(c.back(), c.front());
+
+  c.insert(std::next(c.begin()), *std::next(c.begin(), 3));
+  EXPECT_EQ(*std::next(c.begin(), 4), *std::next(c.begin()));
+  EXPECT_EQ(6, c.size());
+
+  unrolled_container e;
+  mass_push_back(e, {1, 2, 3, 4});
+  e.insert(std::next(e.begin()), e.back());
+  expect_eq(e, {1, 4, 2, 3, 4});
+}
+
+TEST_F(unrolled_list_test, push_back_exception_safety) {
+  faulty_run([] {
+    unrolled_container c;
+
+    auto range = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+    for (int e : range) {
+      strong_exception_safety_guard sg(c);
+      c.push_back(e);
+    }
+    expect_eq(c, range);
+  });
+}
+
+TEST_F(unrolled_list_test, insert_exception_safety) {
+  faulty_run([] {
+    unrolled_container c;
+    mass_push_back(c, {1, 2, 3, 4, 5, 6, 7, 8});
+    try {
+      c.insert(std::next(c.begin()), 42);
+    } catch (...) {
+      fault_injection_disable dg;
+      EXPECT_TRUE(c.size() == 8 || c.size() == 9);
+      EXPECT_EQ(c.size(), std::distance(c.begin(), c.end()));
+      throw;
+    }
+    expect_eq(c, {1, 42, 2, 3, 4, 5, 6, 7, 8});
+  });
+}
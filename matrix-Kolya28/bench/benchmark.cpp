@@ -0,0 +1,218 @@
+#include "matrix.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <string_view>
+
+// Throughput of the matrix kernels, each line is the mean time of one run of a kernel and the rates derived
+// from the number of arithmetic operations and the minimal memory traffic of that kernel. Usage:
+//   benchmark [--threads N] [--min-time SECONDS] [--filter SUBSTRING]
+
+namespace {
+
+struct options {
+  size_t threads = 1;
+  double min_time = 0.2;
+  std::string_view filter;
+};
+
+options opts;
+
+// prevents the compiler from dropping a result or fusing consecutive runs
+template <class T>
+void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "g"(&value) : "memory");
+#else
+  static const void* volatile sink;
+  sink = &value;
+#endif
+}
+
+template <class Run>
+double seconds_per_run(const Run& run) {
+  using clock = std::chrono::steady_clock;
+  run();
+  size_t runs = 0;
+  double elapsed = 0;
+  auto start = clock::now();
+  do {
+    run();
+    ++runs;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < opts.min_time);
+  return elapsed / runs;
+}
+
+template <class Run>
+void measure(std::string_view name, const std::string& shape, double flops, double bytes, const Run& run) {
+  if (name.find(opts.filter) == std::string_view::npos) {
+    return;
+  }
+  double seconds = seconds_per_run(run);
+  std::printf("%-18.*s %-16s %12.2f us", static_cast<int>(name.size()), name.data(), shape.c_str(), seconds * 1e6);
+  if (flops != 0) {
+    std::printf(" %9.2f GFLOP/s", flops / seconds * 1e-9);
+  } else {
+    std::printf(" %17s", "");
+  }
+  std::printf(" %9.2f GB/s\n", bytes / seconds * 1e-9);
+  std::fflush(stdout);
+}
+
+std::string shape(size_t rows, size_t cols) {
+  return std::to_string(rows) + "x" + std::to_string(cols);
+}
+
+template <class T>
+matrix<T> make(size_t rows, size_t cols) {
+  matrix<T> m(rows, cols, matrix_uninitialized);
+  for (size_t i = 0; i < m.size(); ++i) {
+    m.data()[i] = static_cast<T>(i % 13) / 8;
+  }
+  return m;
+}
+
+// the multiplication before the blocked kernel, a dot product of a row and a column per element
+template <class T>
+matrix<T> naive_multiply(const matrix<T>& left, const matrix<T>& right) {
+  matrix<T> result(left.rows(), right.cols());
+  for (size_t i = 0; i < left.rows(); ++i) {
+    for (size_t j = 0; j < right.cols(); ++j) {
+      result(i, j) = std::inner_product(left.row_begin(i), left.row_end(i), right.col_begin(j), T{});
+    }
+  }
+  return result;
+}
+
+template <class T>
+void multiply(const char* type, size_t m, size_t k, size_t n) {
+  matrix<T> a = make<T>(m, k);
+  matrix<T> b = make<T>(k, n);
+  std::string dims = std::to_string(m) + "x" + std::to_string(k) + "x" + std::to_string(n);
+  double flops = 2.0 * m * n * k;
+  double bytes = (m * k + k * n + m * n) * sizeof(T);
+
+  std::string name = std::string("mul/") + type;
+  measure(name, dims, flops, bytes, [&] { keep(matrix<T>(a * b)); });
+  // quadratic in the stride of the column walks, so only for sizes where it finishes in reasonable time
+  if (m * n * k <= size_t{1} << 27) {
+    measure(name + "/naive", dims, flops, bytes, [&] { keep(naive_multiply(a, b)); });
+  }
+}
+
+template <class T>
+void element_wise(const char* type, size_t rows, size_t cols) {
+  matrix<T> a = make<T>(rows, cols);
+  matrix<T> b = make<T>(rows, cols);
+  matrix<T> c = make<T>(rows, cols);
+  matrix<T> d(rows, cols, matrix_uninitialized);
+  std::string dims = shape(rows, cols);
+  double n = static_cast<double>(a.size());
+  double size = n * sizeof(T);
+  auto name = [type](const char* kernel) { return std::string(kernel) + "/" + type; };
+
+  measure(name("add"), dims, n, 3 * size, [&] {
+    d = a + b;
+    keep(d);
+  });
+  measure(name("add/scalar"), dims, n, 3 * size, [&] {
+    matrix_impl::evaluate_scalar(a + b, d.data(), d.cols(), 0, d.rows());
+    keep(d);
+  });
+  measure(name("add_scaled"), dims, 2 * n, 3 * size, [&] {
+    d.add_scaled(b, T(2));
+    keep(d);
+  });
+  measure(name("fused"), dims, 3 * n, 4 * size, [&] {
+    d = a + b * T(2) - c;
+    keep(d);
+  });
+  measure(name("compare"), dims, 0, 2 * size, [&] { keep(a == c); });
+  measure(name("copy"), dims, 0, 2 * size, [&] { keep(matrix<T>(a)); });
+  if (rows == cols) {
+    measure(name("transpose"), dims, 0, 2 * size, [&] {
+      d = a.transpose_view();
+      keep(d);
+    });
+  }
+  measure(name("row_sum"), dims, n, size, [&] {
+    T sum{};
+    for (size_t i = 0; i < a.rows(); ++i) {
+      sum = std::accumulate(a.row_begin(i), a.row_end(i), sum);
+    }
+    keep(sum);
+  });
+  measure(name("col_sum"), dims, n, size, [&] {
+    T sum{};
+    for (size_t j = 0; j < a.cols(); ++j) {
+      sum = std::accumulate(a.col_begin(j), a.col_end(j), sum);
+    }
+    keep(sum);
+  });
+}
+
+const char* isa_name() {
+  switch (matrix_impl::simd::cpu_isa()) {
+  case matrix_impl::simd::isa::avx512:
+    return "avx512";
+  case matrix_impl::simd::isa::avx2:
+    return "avx2";
+  case matrix_impl::simd::isa::baseline:
+    break;
+  }
+  return "baseline";
+}
+
+bool parse(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (i + 1 == argc) {
+      return false;
+    }
+    if (arg == "--threads") {
+      opts.threads = std::strtoull(argv[++i], nullptr, 10);
+    } else if (arg == "--min-time") {
+      opts.min_time = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--filter") {
+      opts.filter = argv[++i];
+    } else {
+      return false;
+    }
+  }
+  return opts.threads != 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (!parse(argc, argv)) {
+    std::fprintf(stderr, "usage: %s [--threads N] [--min-time SECONDS] [--filter SUBSTRING]\n", argv[0]);
+    return 1;
+  }
+  set_matrix_threads(opts.threads);
+  std::printf("threads: %zu, simd: %s\n", matrix_threads(), isa_name());
+#ifndef NDEBUG
+  std::printf("assertions are enabled, configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers\n");
+#endif
+
+  for (size_t n : {64, 256, 1024}) {
+    multiply<float>("float", n, n, n);
+    multiply<double>("double", n, n, n);
+  }
+  multiply<float>("float", 1024, 64, 1024);
+  multiply<float>("float", 64, 4096, 64);
+  multiply<float>("float", 333, 777, 129);
+  multiply<int>("int", 256, 256, 256);
+
+  for (size_t n : {64, 512, 2048}) {
+    element_wise<float>("float", n, n);
+  }
+  element_wise<double>("double", 2048, 2048);
+  element_wise<float>("float", 16, 65536);
+  element_wise<float>("float", 65536, 3);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+// Cache line size, the default alignment of matrix storage so that rows of suitable length start on vector
+// and cache line boundaries.
+inline constexpr size_t MATRIX_ALIGNMENT = 64;
+
+// Stateless allocator returning storage aligned to at least Alignment bytes.
+template <class T, size_t Alignment = MATRIX_ALIGNMENT>
+class aligned_allocator {
+  static_assert((Alignment & (Alignment - 1)) == 0, "Alignment should be a power of two");
+
+public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  static constexpr size_t alignment = std::max(Alignment, alignof(T));
+
+  template <class U>
+  struct rebind {
+    using other = aligned_allocator<U, Alignment>;
+  };
+
+  aligned_allocator() = default;
+
+  template <class U>
+  aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+  // The aligned operator new is several times slower than the plain one for small blocks, so the block is
+  // over-allocated instead and the offset of the returned storage is kept right before it.
+  T* allocate(size_t n) {
+    if (n > (std::numeric_limits<size_t>::max() - alignment) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    if constexpr (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    } else {
+      auto* block = static_cast<std::byte*>(::operator new(n * sizeof(T) + alignment));
+      // at least __STDCPP_DEFAULT_NEW_ALIGNMENT__, which leaves room for the offset
+      size_t offset = alignment - reinterpret_cast<std::uintptr_t>(block) % alignment;
+      std::byte* storage = block + offset;
+      std::memcpy(storage - sizeof(size_t), &offset, sizeof(size_t));
+      return reinterpret_cast<T*>(storage);
+    }
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    if constexpr (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(p, n * sizeof(T));
+    } else {
+      auto* storage = reinterpret_cast<std::byte*>(p);
+      size_t offset;
+      std::memcpy(&offset, storage - sizeof(size_t), sizeof(size_t));
+      ::operator delete(storage - offset, n * sizeof(T) + alignment);
+    }
+  }
+
+  template <class U>
+  friend bool operator==(const aligned_allocator&, const aligned_allocator<U, Alignment>&) noexcept {
+    return true;
+  }
+};
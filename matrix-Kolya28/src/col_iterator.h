@@ -0,0 +1,124 @@
+#pragma once
+
+#include "matrix_fwd.h"
+
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace matrix_impl {
+// iterates over one column of a row-major matrix with rows cols elements apart,
+// shared by matrix, static_matrix and matrix_view so that algorithms work on all of them.
+// The position is a row index rather than a row pointer: the row below a submatrix at the bottom of its matrix
+// starts past the end of the matrix, so the end of such a column has no valid pointer
+template <class U>
+class col_iterator {
+  template <class, class>
+  friend class ::matrix;
+  template <class, size_t, size_t>
+  friend class ::static_matrix;
+  template <class>
+  friend class ::matrix_view;
+  friend col_iterator<std::remove_const_t<U>>;
+
+public:
+  using value_type = std::remove_const_t<U>;
+  using reference = U&;
+  using pointer = U*;
+  using difference_type = std::ptrdiff_t;
+  using iterator_category = std::random_access_iterator_tag;
+
+private:
+  pointer _data;
+  difference_type _row;
+  size_t _col_index;
+  size_t _cols;
+
+  constexpr col_iterator(pointer data, size_t row, size_t col_index, size_t cols)
+      : _data(data),
+        _row(static_cast<difference_type>(row)),
+        _col_index(col_index),
+        _cols(cols) {}
+
+public:
+  col_iterator() = default;
+
+  constexpr operator col_iterator<const U>() const {
+    return col_iterator<const U>(_data, _row, _col_index, _cols);
+  }
+
+  constexpr col_iterator& operator++() {
+    ++_row;
+    return *this;
+  }
+
+  constexpr col_iterator& operator--() {
+    --_row;
+    return *this;
+  }
+
+  constexpr col_iterator operator++(int) {
+    col_iterator copy(*this);
+    ++*this;
+    return copy;
+  }
+
+  constexpr col_iterator operator--(int) {
+    col_iterator copy(*this);
+    --*this;
+    return copy;
+  }
+
+  constexpr col_iterator operator+(difference_type diff) const {
+    return col_iterator(*this) += diff;
+  }
+
+  friend constexpr col_iterator operator+(difference_type diff, const col_iterator& it) {
+    return it + diff;
+  }
+
+  constexpr col_iterator operator-(difference_type diff) const {
+    return col_iterator(*this) -= diff;
+  }
+
+  friend constexpr difference_type operator-(const col_iterator& left, const col_iterator& right) {
+    assert(left._data == right._data && left._col_index == right._col_index && left._cols == right._cols);
+    return left._row - right._row;
+  }
+
+  constexpr col_iterator& operator+=(difference_type diff) {
+    _row += diff;
+    return *this;
+  }
+
+  constexpr col_iterator& operator-=(difference_type diff) {
+    _row -= diff;
+    return *this;
+  }
+
+  constexpr reference operator*() const {
+    return *operator->();
+  }
+
+  constexpr pointer operator->() const {
+    return _data + (_row * static_cast<difference_type>(_cols) + static_cast<difference_type>(_col_index));
+  }
+
+  constexpr reference operator[](difference_type offset) const {
+    return *(*this + offset);
+  }
+
+  friend constexpr auto operator<=>(const col_iterator& left, const col_iterator& right) {
+    assert(left._data == right._data && left._col_index == right._col_index && left._cols == right._cols);
+    return left._row <=> right._row;
+  }
+
+  friend constexpr bool operator==(const col_iterator& left, const col_iterator& right) {
+    return std::is_eq(left <=> right);
+  }
+
+  friend bool operator!=(const col_iterator& left, const col_iterator& right) = default;
+};
+} // namespace matrix_impl
@@ -0,0 +1,386 @@
+#pragma once
+
+#include "matrix_fwd.h"
+#include "simd.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace matrix_impl {
+// Lazy element-wise arithmetic. Nodes are small values that keep pointers to the operand matrices, so an
+// expression must not outlive the matrices it refers to. Evaluation loads either a single element or a whole
+// vector of count elements of one row starting at (row, col); everything is passed by reference so that vectors
+// never cross a call boundary of a different target.
+struct expression_base {};
+
+// base of matrix and the view types, it makes the operators below visible to them through ADL
+struct operand_base {};
+
+template <class E>
+concept expression = std::is_base_of_v<expression_base, E>;
+
+template <class M>
+struct is_matrix : std::false_type {};
+
+template <class T, class Allocator>
+struct is_matrix<matrix<T, Allocator>> : std::true_type {};
+
+template <class M>
+concept operand = expression<M> || std::is_base_of_v<operand_base, M>;
+
+template <class L, class R>
+concept compatible_operands =
+    operand<L> && operand<R> && std::is_same_v<typename L::value_type, typename R::value_type>;
+
+// number of elements from the first to the last one of a block
+inline size_t extent(size_t rows, size_t cols, size_t stride) noexcept {
+  return rows == 0 || cols == 0 ? 0 : (rows - 1) * stride + cols;
+}
+
+template <class T>
+bool overlap(const T* a, size_t a_size, const T* b, size_t b_size) noexcept {
+  std::less<const T*> less;
+  return a_size != 0 && b_size != 0 && less(a, b + b_size) && less(b, a + a_size);
+}
+
+// elements of a row-major block, consecutive rows are stride elements apart
+template <class T>
+class terminal : expression_base {
+public:
+  using value_type = T;
+
+  terminal(const T* data, size_t rows, size_t cols, size_t stride) noexcept
+      : _data(data),
+        _rows(rows),
+        _cols(cols),
+        _stride(stride) {}
+
+  size_t rows() const noexcept {
+    return _rows;
+  }
+
+  size_t cols() const noexcept {
+    return _cols;
+  }
+
+  // whether evaluating into a block of the same shape at out could overwrite elements before they are read,
+  // reading and writing exactly the same elements is fine since every element depends only on its position
+  bool aliases(const T* out, size_t stride) const noexcept {
+    return (out != _data || stride != _stride) &&
+           overlap(_data, extent(_rows, _cols, _stride), out, extent(_rows, _cols, stride));
+  }
+
+  template <class U>
+  MATRIX_ALWAYS_INLINE void load(U& out, size_t row, size_t col, [[maybe_unused]] size_t count) const {
+    const T* p = _data + row * _stride + col;
+    if constexpr (std::is_same_v<U, T>) {
+      out = *p;
+    } else {
+#if MATRIX_SIMD
+      simd::load(out, p, count);
+#endif
+    }
+  }
+
+private:
+  const T* _data;
+  size_t _rows;
+  size_t _cols;
+  size_t _stride;
+};
+
+// transpose of a row-major block, a row of it is a strided column of the block
+template <class T>
+class transposed_terminal : expression_base {
+public:
+  using value_type = T;
+
+  transposed_terminal(const T* data, size_t rows, size_t cols, size_t stride) noexcept
+      : _data(data),
+        _rows(rows),
+        _cols(cols),
+        _stride(stride) {}
+
+  size_t rows() const noexcept {
+    return _rows;
+  }
+
+  size_t cols() const noexcept {
+    return _cols;
+  }
+
+  bool aliases(const T* out, size_t stride) const noexcept {
+    return overlap(_data, extent(_cols, _rows, _stride), out, extent(_rows, _cols, stride));
+  }
+
+  template <class U>
+  MATRIX_ALWAYS_INLINE void load(U& out, size_t row, size_t col, size_t count) const {
+    const T* p = _data + col * _stride + row;
+    if constexpr (std::is_same_v<U, T>) {
+      out = *p;
+    } else {
+      T lanes[sizeof(U) / sizeof(T)] = {};
+      for (size_t k = 0; k < count; ++k) {
+        lanes[k] = p[k * _stride];
+      }
+      std::memcpy(&out, lanes, sizeof(U));
+    }
+  }
+
+private:
+  const T* _data;
+  size_t _rows;
+  size_t _cols;
+  size_t _stride;
+};
+
+struct plus {
+  template <class U>
+  MATRIX_ALWAYS_INLINE static void apply(U& x, const U& y) {
+    x = x + y;
+  }
+};
+
+struct minus {
+  template <class U>
+  MATRIX_ALWAYS_INLINE static void apply(U& x, const U& y) {
+    x = x - y;
+  }
+};
+
+template <class Op, class L, class R>
+class binary : expression_base {
+public:
+  using value_type = typename L::value_type;
+
+  binary(const L& left, const R& right) : _left(left), _right(right) {
+    assert(left.cols() == right.cols() && left.rows() == right.rows() && "Matrices should have equal dimensions");
+  }
+
+  size_t rows() const noexcept {
+    return _left.rows();
+  }
+
+  size_t cols() const noexcept {
+    return _left.cols();
+  }
+
+  bool aliases(const value_type* out, size_t stride) const noexcept {
+    return _left.aliases(out, stride) || _right.aliases(out, stride);
+  }
+
+  template <class U>
+  MATRIX_ALWAYS_INLINE void load(U& out, size_t row, size_t col, size_t count) const {
+    U other;
+    _left.load(out, row, col, count);
+    _right.load(other, row, col, count);
+    Op::apply(out, other);
+  }
+
+private:
+  L _left;
+  R _right;
+};
+
+template <class E>
+class scaled : expression_base {
+public:
+  using value_type = typename E::value_type;
+
+  scaled(const E& operand, const value_type& factor) : _operand(operand), _factor(factor) {}
+
+  size_t rows() const noexcept {
+    return _operand.rows();
+  }
+
+  size_t cols() const noexcept {
+    return _operand.cols();
+  }
+
+  bool aliases(const value_type* out, size_t stride) const noexcept {
+    return _operand.aliases(out, stride);
+  }
+
+  template <class U>
+  MATRIX_ALWAYS_INLINE void load(U& out, size_t row, size_t col, size_t count) const {
+    _operand.load(out, row, col, count);
+    out = out * _factor;
+  }
+
+private:
+  E _operand;
+  value_type _factor;
+};
+
+template <class T, class Allocator>
+terminal<T> node(const matrix<T, Allocator>& m) noexcept {
+  return {m.data(), m.rows(), m.cols(), m.cols()};
+}
+
+template <class T>
+terminal<std::remove_const_t<T>> node(const matrix_view<T>& v) noexcept {
+  return {v.data(), v.rows(), v.cols(), v.stride()};
+}
+
+template <class T>
+transposed_terminal<std::remove_const_t<T>> node(const transposed_view<T>& v) noexcept {
+  return {v.transpose_view().data(), v.rows(), v.cols(), v.transpose_view().stride()};
+}
+
+template <expression E>
+E node(const E& e) noexcept {
+  return e;
+}
+
+template <class M>
+using node_t = decltype(node(std::declval<const M&>()));
+
+template <class Op, class L, class R>
+requires compatible_operands<L, R>
+binary<Op, node_t<L>, node_t<R>> make_binary(const L& left, const R& right) {
+  return {node(left), node(right)};
+}
+
+template <operand M>
+scaled<node_t<M>> make_scaled(const M& m, const typename M::value_type& factor) {
+  return {node(m), factor};
+}
+
+template <expression E, class T>
+void evaluate_scalar(const E& e, T* out, size_t stride, size_t first, size_t last) {
+  for (size_t i = first; i < last; ++i) {
+    for (size_t j = 0; j < e.cols(); ++j) {
+      T x;
+      e.load(x, i, j, 1);
+      out[i * stride + j] = std::move(x);
+    }
+  }
+}
+
+#if MATRIX_SIMD
+template <size_t Bytes, expression E, class T>
+MATRIX_ALWAYS_INLINE void evaluate_batches(const E& e, T* out, size_t stride, size_t first, size_t last) {
+  using V = simd::batch<T, Bytes>;
+  constexpr size_t width = Bytes / sizeof(T);
+  size_t cols = e.cols();
+  for (size_t i = first; i < last; ++i) {
+    T* row = out + i * stride;
+    size_t j = 0;
+    for (; j + width <= cols; j += width) {
+      V x;
+      e.load(x, i, j, width);
+      simd::store(x, row + j, width);
+    }
+    if (j < cols) {
+      V x;
+      e.load(x, i, j, cols - j);
+      simd::store(x, row + j, cols - j);
+    }
+  }
+}
+
+#if MATRIX_SIMD_X86
+template <expression E, class T>
+[[gnu::target("avx512f")]] void evaluate_avx512(const E& e, T* out, size_t stride, size_t first, size_t last) {
+  evaluate_batches<64>(e, out, stride, first, last);
+}
+
+template <expression E, class T>
+[[gnu::target("avx2")]] void evaluate_avx2(const E& e, T* out, size_t stride, size_t first, size_t last) {
+  evaluate_batches<32>(e, out, stride, first, last);
+}
+#endif
+#endif
+
+// rows [first, last) of out = e with the widest vectors the cpu supports
+template <expression E, class T>
+void evaluate(const E& e, T* out, size_t stride, size_t first, size_t last) {
+  if constexpr (simd::value<T>) {
+#if MATRIX_SIMD_X86
+    switch (simd::cpu_isa()) {
+    case simd::isa::avx512:
+      return evaluate_avx512(e, out, stride, first, last);
+    case simd::isa::avx2:
+      return evaluate_avx2(e, out, stride, first, last);
+    case simd::isa::baseline:
+      break;
+    }
+#endif
+#if MATRIX_SIMD
+    evaluate_batches<16>(e, out, stride, first, last);
+#endif
+  } else {
+    evaluate_scalar(e, out, stride, first, last);
+  }
+}
+
+constexpr size_t PARALLEL_MIN_ELEMENTS = size_t{1} << 16;
+
+// rows per task so that element-wise work is only split when it pays for the scheduling
+inline size_t parallel_grain(size_t cols) noexcept {
+  return (PARALLEL_MIN_ELEMENTS + cols - 1) / std::max<size_t>(cols, 1);
+}
+
+// out = e for a block of the same shape with rows stride elements apart, e must not alias it
+template <expression E, class T>
+void assign(const E& e, T* out, size_t stride) {
+  parallel_for(e.rows(), parallel_grain(e.cols()),
+               [&](size_t first, size_t last) { evaluate(e, out, stride, first, last); });
+}
+
+// defined with matrix
+template <class T, class Allocator = aligned_allocator<T>>
+matrix<T, Allocator> multiply(matrix_view<const T> left, matrix_view<const T> right,
+                              const Allocator& alloc = Allocator());
+
+// matrix products read their operands as strided blocks, everything else is evaluated first
+template <operand M>
+decltype(auto) evaluated(const M& m) {
+  if constexpr (std::is_same_v<node_t<M>, terminal<typename M::value_type>>) {
+    return m;
+  } else {
+    return matrix<typename M::value_type>(m);
+  }
+}
+
+// operators for expressions and views, the ones for two matrices of the same type are hidden friends of matrix
+
+template <class L, class R>
+concept mixed_operands = compatible_operands<L, R> && (!is_matrix<L>::value || !std::is_same_v<L, R>);
+
+template <class L, class R>
+requires mixed_operands<L, R>
+auto operator+(const L& left, const R& right) {
+  return make_binary<plus>(left, right);
+}
+
+template <class L, class R>
+requires mixed_operands<L, R>
+auto operator-(const L& left, const R& right) {
+  return make_binary<minus>(left, right);
+}
+
+template <operand E>
+requires(!is_matrix<E>::value)
+auto operator*(const E& left, const typename E::value_type& right) {
+  return make_scaled(left, right);
+}
+
+template <operand E>
+requires(!is_matrix<E>::value)
+auto operator*(const typename E::value_type& left, const E& right) {
+  return make_scaled(right, left);
+}
+
+template <class L, class R>
+requires mixed_operands<L, R>
+matrix<typename L::value_type> operator*(const L& left, const R& right) {
+  return multiply<typename L::value_type>(evaluated(left), evaluated(right));
+}
+} // namespace matrix_impl
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "simd.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace matrix_impl {
+template <class T>
+concept gemm_value = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// rows and columns of the output tile of a micro-kernel on vectors of width elements, width 1 is the scalar one.
+// The 6 x 2 vectors of accumulators take 12 of the 16 vector registers of SSE2 and AVX2 and leave room for the
+// row of B and the broadcast element of A
+constexpr size_t gemm_mr(size_t width) noexcept {
+  return width == 1 ? 4 : 6;
+}
+
+constexpr size_t gemm_nr(size_t width) noexcept {
+  return width == 1 ? 4 : 2 * width;
+}
+
+// an MR x NR tile of accumulators stays in registers, a KC x NR panel of B in L1, an MC x KC block of A in L2
+// and a KC x NC block of B in L3
+template <class T, size_t WIDTH>
+struct gemm_blocking {
+  static constexpr size_t MR = gemm_mr(WIDTH);
+  static constexpr size_t NR = gemm_nr(WIDTH);
+  static constexpr size_t KC = std::clamp<size_t>(16384 / (NR * sizeof(T)), 128, 512);
+  static constexpr size_t MC = 128 / MR * MR;
+  static constexpr size_t NC = 2048;
+};
+
+// packs rows [0, mc) x cols [0, kc) of a into MR-row panels, each stored column by column and zero padded
+template <class T, size_t MR>
+void pack_a(const T* a, size_t lda, size_t mc, size_t kc, T* packed) {
+  for (size_t i = 0; i < mc; i += MR) {
+    size_t mr = std::min(MR, mc - i);
+    for (size_t p = 0; p < kc; ++p) {
+      for (size_t ir = 0; ir < MR; ++ir) {
+        *packed++ = ir < mr ? a[(i + ir) * lda + p] : T{};
+      }
+    }
+  }
+}
+
+// packs rows [0, kc) x cols [0, nc) of b into NR-col panels, each stored row by row and zero padded
+template <class T, size_t NR>
+void pack_b(const T* b, size_t ldb, size_t kc, size_t nc, T* packed) {
+  for (size_t j = 0; j < nc; j += NR) {
+    size_t nr = std::min(NR, nc - j);
+    for (size_t p = 0; p < kc; ++p) {
+      const T* row = b + p * ldb + j;
+      std::copy_n(row, nr, packed);
+      std::fill(packed + nr, packed + NR, T{});
+      packed += NR;
+    }
+  }
+}
+
+// c[0, mr) x [0, nr) = a_panel * b_panel, or += when accumulate
+template <class T, size_t MR, size_t NR>
+void micro_kernel(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t mr, size_t nr, bool accumulate) {
+  T acc[MR][NR] = {};
+  for (size_t p = 0; p < kc; ++p) {
+    for (size_t i = 0; i < MR; ++i) {
+      T x = a[i];
+      for (size_t j = 0; j < NR; ++j) {
+        acc[i][j] += x * b[j];
+      }
+    }
+    a += MR;
+    b += NR;
+  }
+  if (accumulate) {
+    for (size_t i = 0; i < mr; ++i) {
+      for (size_t j = 0; j < nr; ++j) {
+        c[i * ldc + j] += acc[i][j];
+      }
+    }
+  } else {
+    for (size_t i = 0; i < mr; ++i) {
+      std::copy_n(acc[i], nr, c + i * ldc);
+    }
+  }
+}
+
+#if MATRIX_SIMD
+// the same on an MR x NV tile of Bytes wide vectors, each step broadcasts an element of a against a row of b
+template <size_t Bytes, class T, size_t MR, size_t NR>
+MATRIX_ALWAYS_INLINE void micro_kernel_batches(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t mr,
+                                               size_t nr, bool accumulate) {
+  using V = simd::batch<T, Bytes>;
+  constexpr size_t width = Bytes / sizeof(T);
+  constexpr size_t NV = NR / width;
+  static_assert(NV * width == NR);
+
+  V acc[MR][NV] = {};
+  for (size_t p = 0; p < kc; ++p) {
+    V row[NV];
+    for (size_t j = 0; j < NV; ++j) {
+      simd::load(row[j], b + j * width, width);
+    }
+    for (size_t i = 0; i < MR; ++i) {
+      for (size_t j = 0; j < NV; ++j) {
+        acc[i][j] += a[i] * row[j];
+      }
+    }
+    a += MR;
+    b += NR;
+  }
+  for (size_t i = 0; i < mr; ++i) {
+    for (size_t j = 0; j * width < nr; ++j) {
+      size_t count = std::min(width, nr - j * width);
+      T* out = c + i * ldc + j * width;
+      if (accumulate) {
+        V x;
+        simd::load(x, out, count);
+        acc[i][j] += x;
+      }
+      simd::store(acc[i][j], out, count);
+    }
+  }
+}
+#endif
+
+// c[m x n] = a[m x k] * b[k x n] for k != 0 with micro-kernels on vectors of Bytes, or scalar ones when Bytes == 0
+template <size_t Bytes, class T>
+MATRIX_ALWAYS_INLINE void gemm_blocked(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb,
+                                       T* c, size_t ldc) {
+  using blocking = gemm_blocking<T, std::max<size_t>(Bytes / sizeof(T), 1)>;
+  constexpr size_t MR = blocking::MR;
+  constexpr size_t NR = blocking::NR;
+
+  size_t nc_max = std::min(blocking::NC, (n + NR - 1) / NR * NR);
+  size_t mc_max = std::min(blocking::MC, (m + MR - 1) / MR * MR);
+  size_t kc_max = std::min(blocking::KC, k);
+  std::vector<T> packed_a(mc_max * kc_max);
+  std::vector<T> packed_b(kc_max * nc_max);
+
+  for (size_t jc = 0; jc < n; jc += blocking::NC) {
+    size_t nc = std::min(blocking::NC, n - jc);
+    for (size_t pc = 0; pc < k; pc += blocking::KC) {
+      size_t kc = std::min(blocking::KC, k - pc);
+      pack_b<T, NR>(b + pc * ldb + jc, ldb, kc, nc, packed_b.data());
+
+      for (size_t ic = 0; ic < m; ic += blocking::MC) {
+        size_t mc = std::min(blocking::MC, m - ic);
+        pack_a<T, MR>(a + ic * lda + pc, lda, mc, kc, packed_a.data());
+
+        for (size_t jr = 0; jr < nc; jr += NR) {
+          const T* b_panel = packed_b.data() + jr * kc;
+          for (size_t ir = 0; ir < mc; ir += MR) {
+            const T* a_panel = packed_a.data() + ir * kc;
+            T* c_tile = c + (ic + ir) * ldc + jc + jr;
+            size_t mr = std::min(MR, mc - ir);
+            size_t nr = std::min(NR, nc - jr);
+#if MATRIX_SIMD
+            if constexpr (Bytes != 0) {
+              micro_kernel_batches<Bytes, T, MR, NR>(kc, a_panel, b_panel, c_tile, ldc, mr, nr, pc != 0);
+              continue;
+            }
+#endif
+            micro_kernel<T, MR, NR>(kc, a_panel, b_panel, c_tile, ldc, mr, nr, pc != 0);
+          }
+        }
+      }
+    }
+  }
+}
+
+#if MATRIX_SIMD_X86
+template <class T>
+[[gnu::target("avx512f")]] void gemm_avx512(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b,
+                                            size_t ldb, T* c, size_t ldc) {
+  gemm_blocked<64>(m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+template <class T>
+[[gnu::target("avx2,fma")]] void gemm_avx2(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b,
+                                           size_t ldb, T* c, size_t ldc) {
+  gemm_blocked<32>(m, n, k, a, lda, b, ldb, c, ldc);
+}
+#endif
+
+// width in bytes of the vectors of the micro-kernel gemm runs for T, 0 for the scalar one
+template <class T>
+size_t gemm_vector_bytes() noexcept {
+  if constexpr (simd::value<T>) {
+    switch (simd::cpu_isa()) {
+    case simd::isa::avx512:
+      return 64;
+    case simd::isa::avx2:
+      return 32;
+    case simd::isa::baseline:
+      break;
+    }
+    return 16;
+  } else {
+    return 0;
+  }
+}
+
+// c[m x n] = a[m x k] * b[k x n], all row-major with leading dimensions lda, ldb and ldc,
+// c is only written, so it may be uninitialized
+template <gemm_value T>
+void gemm(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc) {
+  if (k == 0) {
+    for (size_t i = 0; i < m; ++i) {
+      std::fill_n(c + i * ldc, n, T{});
+    }
+    return;
+  }
+
+  if constexpr (simd::value<T>) {
+#if MATRIX_SIMD_X86
+    switch (simd::cpu_isa()) {
+    case simd::isa::avx512:
+      return gemm_avx512(m, n, k, a, lda, b, ldb, c, ldc);
+    case simd::isa::avx2:
+      return gemm_avx2(m, n, k, a, lda, b, ldb, c, ldc);
+    case simd::isa::baseline:
+      break;
+    }
+#endif
+#if MATRIX_SIMD
+    gemm_blocked<16>(m, n, k, a, lda, b, ldb, c, ldc);
+#endif
+  } else {
+    gemm_blocked<0>(m, n, k, a, lda, b, ldb, c, ldc);
+  }
+}
+
+constexpr size_t PARALLEL_GEMM_MIN_FLOPS = size_t{1} << 21;
+
+// gemm split into output tiles computed on the shared pool, about two tiles per thread, serial in a task of a pool
+template <gemm_value T>
+void parallel_gemm(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb, T* c,
+                   size_t ldc) {
+  thread_pool* pool = thread_pool::in_task() ? nullptr : shared_pool().get();
+  if (pool == nullptr || m * n * k < PARALLEL_GEMM_MIN_FLOPS) {
+    gemm(m, n, k, a, lda, b, ldb, c, ldc);
+    return;
+  }
+
+  size_t width = std::max<size_t>(gemm_vector_bytes<T>() / sizeof(T), 1);
+  size_t mr = gemm_mr(width);
+  size_t nr = gemm_nr(width);
+  auto split = [](size_t size, size_t parts, size_t step) {
+    size_t tile = (size + parts - 1) / parts;
+    return std::max((tile + step - 1) / step * step, step);
+  };
+  size_t tiles = 2 * pool->size();
+  size_t tile_rows = split(m, tiles, mr);
+  size_t row_tiles = (m + tile_rows - 1) / tile_rows;
+  size_t tile_cols = split(n, (tiles + row_tiles - 1) / row_tiles, nr);
+  size_t col_tiles = (n + tile_cols - 1) / tile_cols;
+
+  pool->run(row_tiles * col_tiles, [&](size_t tile) {
+    size_t i = tile / col_tiles * tile_rows;
+    size_t j = tile % col_tiles * tile_cols;
+    gemm(std::min(tile_rows, m - i), std::min(tile_cols, n - j), k, a + i * lda, lda, b + j, ldb, c + i * ldc + j,
+         ldc);
+  });
+}
+} // namespace matrix_impl
@@ -1,118 +1,32 @@
 #pragma once
 
+#include "col_iterator.h"
+#include "expression.h"
+#include "gemm.h"
+#include "matrix_fwd.h"
+#include "matrix_view.h"
+
 #include <algorithm>
 #include <cassert>
 #include <compare>
 #include <cstddef>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <numeric>
+#include <type_traits>
 #include <utility>
 
-template <class T>
-class matrix {
-private:
-  template <class U>
-  class basic_col_iterator {
-    friend matrix;
-
-  public:
-    using value_type = T;
-    using reference = U&;
-    using pointer = U*;
-    using difference_type = std::ptrdiff_t;
-    using iterator_category = std::random_access_iterator_tag;
-
-  private:
-    pointer _data;
-    size_t _col_index;
-    size_t _cols;
-
-    basic_col_iterator(pointer data, size_t col_index, size_t cols) : _data(data), _col_index(col_index), _cols(cols) {}
-
-  public:
-    basic_col_iterator() = default;
-
-    operator basic_col_iterator<const U>() const {
-      return basic_col_iterator<const U>(_data, _col_index, _cols);
-    }
-
-    basic_col_iterator& operator++() {
-      _data += _cols;
-      return *this;
-    }
-
-    basic_col_iterator& operator--() {
-      _data -= _cols;
-      return *this;
-    }
-
-    basic_col_iterator operator++(int) {
-      basic_col_iterator copy(*this);
-      ++*this;
-      return copy;
-    }
-
-    basic_col_iterator operator--(int) {
-      basic_col_iterator copy(*this);
-      --*this;
-      return copy;
-    }
+template <class T, class Allocator>
+class matrix : matrix_impl::operand_base {
+  using alloc_traits = std::allocator_traits<Allocator>;
 
-    basic_col_iterator operator+(difference_type diff) const {
-      return basic_col_iterator(*this) += diff;
-    }
-
-    friend basic_col_iterator operator+(difference_type diff, const basic_col_iterator& it) {
-      return it + diff;
-    }
-
-    basic_col_iterator operator-(difference_type diff) const {
-      return basic_col_iterator(*this) -= diff;
-    }
-
-    friend difference_type operator-(const basic_col_iterator& left, const basic_col_iterator& right) {
-      assert(left._cols == right._cols && left._col_index == right._col_index);
-      return (left._data - right._data) / static_cast<difference_type>(left._cols);
-    }
-
-    basic_col_iterator& operator+=(difference_type diff) {
-      _data += static_cast<difference_type>(_cols) * diff;
-      return *this;
-    }
-
-    basic_col_iterator& operator-=(difference_type diff) {
-      _data -= static_cast<difference_type>(_cols) * diff;
-      return *this;
-    }
-
-    reference operator*() const {
-      return _data[_col_index];
-    }
-
-    pointer operator->() const {
-      return _data + _col_index;
-    }
-
-    reference operator[](difference_type offset) const {
-      offset *= _cols;
-      return (_data + offset)[_col_index];
-    }
-
-    friend auto operator<=>(const basic_col_iterator& left, const basic_col_iterator& right) {
-      assert(left._col_index == right._col_index && left._cols == right._cols);
-      return left._data <=> right._data;
-    }
-
-    friend bool operator==(const basic_col_iterator& left, const basic_col_iterator& right) {
-      return std::is_eq(left <=> right);
-    }
-
-    friend bool operator!=(const basic_col_iterator& left, const basic_col_iterator& right) = default;
-  };
+  static_assert(std::is_same_v<typename alloc_traits::value_type, T>, "Allocator should allocate matrix elements");
+  static_assert(std::is_same_v<typename alloc_traits::pointer, T*>, "Allocator should return plain pointers");
 
 public:
   using value_type = T;
+  using allocator_type = Allocator;
 
   using reference = value_type&;
   using const_reference = const value_type&;
@@ -126,70 +40,125 @@ public:
   using row_iterator = pointer;
   using const_row_iterator = const_pointer;
 
-  using col_iterator = basic_col_iterator<value_type>;
-  using const_col_iterator = basic_col_iterator<const value_type>;
+  using col_iterator = matrix_impl::col_iterator<value_type>;
+  using const_col_iterator = matrix_impl::col_iterator<const value_type>;
 
 private:
   value_type* _data;
   size_t _rows;
   size_t _cols;
+  [[no_unique_address]] allocator_type _alloc;
 
 public:
-  matrix() : _data(nullptr), _rows(0), _cols(0) {}
+  matrix() noexcept(noexcept(allocator_type())) : matrix(allocator_type()) {}
 
-  matrix(size_t rows, size_t cols) : _rows(rows), _cols(cols) {
-    size_t s = size();
-    if (s == 0) {
-      _data = nullptr;
-      _rows = _cols = 0;
-    } else {
-      _data = new value_type[s]{};
-    }
+  explicit matrix(const allocator_type& alloc) noexcept : _data(nullptr), _rows(0), _cols(0), _alloc(alloc) {}
+
+  matrix(size_t rows, size_t cols, const allocator_type& alloc = allocator_type()) : _alloc(alloc) {
+    create(rows, cols, [this] { construct_each([this](pointer p, size_t) { alloc_traits::construct(_alloc, p); }); });
+  }
+
+  // for matrices that are overwritten right away, elements are default-initialized, so trivial ones aren't
+  // written at all
+  matrix(size_t rows, size_t cols, matrix_uninitialized_t, const allocator_type& alloc = allocator_type())
+      : _alloc(alloc) {
+    create(rows, cols, [this] { construct_default(); });
   }
 
   template <size_t Rows, size_t Cols>
-  matrix(const value_type (&init)[Rows][Cols]) : _data(new value_type[Rows * Cols]),
-                                                 _rows(Rows),
-                                                 _cols(Cols) {
+  matrix(const value_type (&init)[Rows][Cols], const allocator_type& alloc = allocator_type()) : _alloc(alloc) {
     // array of size 0 doesn't exist
-    iterator it = begin();
-    for (const value_type(&row)[Cols] : init) {
-      it = std::copy_n(row, cols(), it);
-    }
+    create(Rows, Cols, [&] {
+      construct_default();
+      iterator it = begin();
+      for (const value_type(&row)[Cols] : init) {
+        it = std::copy_n(row, cols(), it);
+      }
+    });
   }
 
-  matrix(const matrix& other) : _rows(other.rows()), _cols(other.cols()) {
-    if (other.empty()) {
-      _data = nullptr;
-    } else {
-      _data = new value_type[size()];
-      std::copy(other.begin(), other.end(), begin());
-    }
+  matrix(const matrix& other) : matrix(other, alloc_traits::select_on_container_copy_construction(other._alloc)) {}
+
+  matrix(const matrix& other, const allocator_type& alloc) : _alloc(alloc) {
+    create(other.rows(), other.cols(), [&] {
+      construct_default();
+      try {
+        matrix_impl::parallel_for(rows(), matrix_impl::parallel_grain(cols()), [&](size_t first, size_t last) {
+          std::copy(other.row_begin(first), other.row_begin(first) + (last - first) * cols(), row_begin(first));
+        });
+      } catch (...) {
+        destroy(size());
+        throw;
+      }
+    });
+  }
+
+  // evaluates an expression or copies the elements of a view
+  template <matrix_impl::operand M>
+  requires(!std::is_same_v<M, matrix>) && std::is_same_v<typename M::value_type, value_type>
+  matrix(const M& other, const allocator_type& alloc = allocator_type()) : _alloc(alloc) {
+    create(other.rows(), other.cols(), [&] {
+      construct_default();
+      try {
+        matrix_impl::assign(matrix_impl::node(other), data(), cols());
+      } catch (...) {
+        destroy(size());
+        throw;
+      }
+    });
   }
 
-  matrix(matrix&& other)
+  matrix(matrix&& other) noexcept
       : _data(std::exchange(other._data, nullptr)),
         _rows(std::exchange(other._rows, 0)),
-        _cols(std::exchange(other._cols, 0)) {}
+        _cols(std::exchange(other._cols, 0)),
+        _alloc(std::move(other._alloc)) {}
 
   matrix& operator=(const matrix& other) {
     if (&other != this) {
-      *this = matrix(other);
+      if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+        replace<true>(matrix(other, other._alloc));
+      } else {
+        replace(matrix(other, _alloc));
+      }
     }
     return *this;
   }
 
-  matrix& operator=(matrix&& other) {
+  // reuses the storage when the shape matches, the operand may refer to *this
+  template <matrix_impl::operand M>
+  requires(!std::is_same_v<M, matrix>) && std::is_same_v<typename M::value_type, value_type>
+  matrix& operator=(const M& other) {
+    if (cols() == other.cols() && rows() == other.rows()) {
+      return assign(other);
+    }
+    return replace(matrix(other, _alloc));
+  }
+
+  matrix& operator=(matrix&& other) noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                                             alloc_traits::is_always_equal::value) {
     if (&other != this) {
-      std::swap(_data, other._data);
-      std::swap(_rows, other._rows);
-      std::swap(_cols, other._cols);
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+        replace<true>(std::move(other));
+      } else if (_alloc == other._alloc) {
+        replace(std::move(other));
+      } else {
+        // storage of other can't be freed with the allocator of *this
+        replace(matrix(other, _alloc));
+      }
     }
     return *this;
   }
 
   ~matrix() {
-    delete[] data();
+    if (!empty()) {
+      destroy(size());
+      alloc_traits::deallocate(_alloc, data(), size());
+    }
+  }
+
+  allocator_type get_allocator() const {
+    return _alloc;
   }
 
   // Iterators
@@ -232,22 +201,22 @@ public:
 
   col_iterator col_begin(size_t col) {
     assert(col < cols());
-    return col_iterator(begin(), col, cols());
+    return col_iterator(begin(), 0, col, cols());
   }
 
   const_col_iterator col_begin(size_t col) const {
     assert(col < cols());
-    return const_col_iterator(begin(), col, cols());
+    return const_col_iterator(begin(), 0, col, cols());
   }
 
   col_iterator col_end(size_t col) {
     assert(col < cols());
-    return col_iterator(end(), col, cols());
+    return col_iterator(begin(), rows(), col, cols());
   }
 
   const_col_iterator col_end(size_t col) const {
     assert(col < cols());
-    return const_col_iterator(end(), col, cols());
+    return const_col_iterator(begin(), rows(), col, cols());
   }
 
   // Size
@@ -286,11 +255,37 @@ public:
     return _data;
   }
 
+  // Views
+
+  matrix_view<value_type> view() {
+    return *this;
+  }
+
+  matrix_view<const value_type> view() const {
+    return *this;
+  }
+
+  matrix_view<value_type> submatrix(size_t row, size_t col, size_t height, size_t width) {
+    return view().submatrix(row, col, height, width);
+  }
+
+  matrix_view<const value_type> submatrix(size_t row, size_t col, size_t height, size_t width) const {
+    return view().submatrix(row, col, height, width);
+  }
+
+  transposed_view<value_type> transpose_view() {
+    return view().transpose_view();
+  }
+
+  transposed_view<const value_type> transpose_view() const {
+    return view().transpose_view();
+  }
+
   // Comparison
 
   friend bool operator==(const matrix& left, const matrix& right) {
     return left.cols() == right.cols() && left.rows() == right.rows() &&
-           std::equal(left.begin(), left.end(), right.begin());
+           matrix_impl::simd::equal(left.data(), right.data(), left.size());
   }
 
   friend bool operator!=(const matrix& left, const matrix& right) = default;
@@ -300,70 +295,152 @@ public:
   // helpers:
 
 private:
-  template <class BinaryOperation>
-  requires std::is_invocable_r_v<value_type, BinaryOperation, const_reference, const_reference>
-  matrix& transform(const matrix& other, matrix& output, BinaryOperation operation) const {
-    assert(cols() == other.cols() && rows() == other.rows() && "Matrices should have equal dimensions");
-    std::transform(begin(), end(), other.begin(), output.begin(), operation);
-    return output;
-  }
-
-  template <class BinaryOperation>
-  requires std::is_invocable_r_v<value_type, BinaryOperation, const_reference, const_reference>
-  matrix(const matrix& left, const matrix& right, BinaryOperation operation)
-      : _data(new value_type[left.size()]),
-        _rows(left.rows()),
-        _cols(left.cols()) {
-    left.transform(right, *this, operation);
-  }
-
-  matrix multiply(const matrix& other) const {
-    assert(cols() == other.rows());
-    matrix result(rows(), other.cols());
-    for (size_t i = 0; i < rows(); ++i) {
-      for (size_t j = 0; j < other.cols(); ++j) {
-        result(i, j) = std::inner_product(row_begin(i), row_end(i), other.col_begin(j), value_type{});
+  // allocates storage for a rows x cols matrix and calls construct() to construct its elements,
+  // a matrix without elements is always 0 x 0 and has no storage
+  template <class Construct>
+  void create(size_t rows, size_t cols, const Construct& construct) {
+    if (rows == 0 || cols == 0) {
+      _data = nullptr;
+      _rows = _cols = 0;
+      return;
+    }
+    _rows = rows;
+    _cols = cols;
+    _data = alloc_traits::allocate(_alloc, size());
+    try {
+      construct();
+    } catch (...) {
+      alloc_traits::deallocate(_alloc, data(), size());
+      throw;
+    }
+  }
+
+  // constructs element i at p with construct(p, i), destroys the constructed ones if that throws
+  template <class Construct>
+  void construct_each(const Construct& construct) {
+    size_t i = 0;
+    try {
+      for (; i < size(); ++i) {
+        construct(data() + i, i);
       }
+    } catch (...) {
+      destroy(i);
+      throw;
+    }
+  }
+
+  // elements that are assigned right away, trivial ones are left uninitialized
+  void construct_default() {
+    if constexpr (!std::is_trivially_default_constructible_v<value_type> ||
+                  !std::is_trivially_destructible_v<value_type>) {
+      construct_each([this](pointer p, size_t) { alloc_traits::construct(_alloc, p); });
     }
-    return result;
+  }
+
+  void destroy(size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+      alloc_traits::destroy(_alloc, data() + i);
+    }
+  }
+
+  // takes the elements of other, which is left with the previous ones of *this, the allocators are exchanged
+  // as well when they propagate and must be equal otherwise
+  template <bool Propagate = false>
+  matrix& replace(matrix&& other) noexcept {
+    std::swap(_data, other._data);
+    std::swap(_rows, other._rows);
+    std::swap(_cols, other._cols);
+    if constexpr (Propagate) {
+      std::swap(_alloc, other._alloc);
+    }
+    return *this;
+  }
+
+  // evaluates an operand of the same shape in place without allocating, unless it reads elements of *this at
+  // other positions, like a transpose or an overlapping submatrix
+  template <matrix_impl::operand M>
+  matrix& assign(const M& other) {
+    auto e = matrix_impl::node(other);
+    assert(cols() == e.cols() && rows() == e.rows() && "Matrices should have equal dimensions");
+    if (e.aliases(data(), cols())) {
+      return replace(matrix(e, _alloc));
+    }
+    matrix_impl::assign(e, data(), cols());
+    return *this;
   }
 
   // operations:
 
 public:
-  matrix& operator+=(const matrix& other) {
-    return transform(other, *this, std::plus<>());
+  template <matrix_impl::operand M>
+  requires std::is_same_v<typename M::value_type, value_type>
+  matrix& operator+=(const M& other) {
+    return assign(*this + other);
   }
 
-  matrix& operator-=(const matrix& other) {
-    return transform(other, *this, std::minus<>());
+  template <matrix_impl::operand M>
+  requires std::is_same_v<typename M::value_type, value_type>
+  matrix& operator-=(const M& other) {
+    return assign(*this - other);
   }
 
-  matrix& operator*=(const matrix& other) {
-    return *this = multiply(other);
+  template <matrix_impl::operand M>
+  requires std::is_same_v<typename M::value_type, value_type>
+  matrix& operator*=(const M& other) {
+    return *this = *this * other;
   }
 
   matrix& operator*=(const_reference factor) {
-    return transform(*this, *this, [&factor](const_reference x, const_reference) { return x * factor; });
+    return assign(*this * factor);
+  }
+
+  // *this += other * factor in a single pass
+  template <matrix_impl::operand M>
+  requires std::is_same_v<typename M::value_type, value_type>
+  matrix& add_scaled(const M& other, const_reference factor) {
+    return assign(*this + other * factor);
   }
 
-  friend matrix operator+(const matrix& left, const matrix& right) {
-    return matrix(left, right, std::plus<>());
+  // +, - and multiplication by a scalar are lazy: they return expressions that are evaluated in a single pass
+  // on conversion to matrix or assignment
+  friend auto operator+(const matrix& left, const matrix& right) {
+    return matrix_impl::make_binary<matrix_impl::plus>(left, right);
   }
 
-  friend matrix operator-(const matrix& left, const matrix& right) {
-    return matrix(left, right, std::minus<>());
+  friend auto operator-(const matrix& left, const matrix& right) {
+    return matrix_impl::make_binary<matrix_impl::minus>(left, right);
   }
 
   friend matrix operator*(const matrix& left, const matrix& right) {
-    return left.multiply(right);
+    return matrix_impl::multiply<value_type>(left, right, left.get_allocator());
   }
 
-  friend matrix operator*(const matrix& left, const_reference right) {
-    return matrix(left, left, [&right](const_reference x, const_reference) { return x * right; });
+  friend auto operator*(const matrix& left, const_reference right) {
+    return matrix_impl::make_scaled(left, right);
   }
 
-  friend matrix operator*(const_reference left, const matrix& right) {
-    return operator*(right, left);
+  friend auto operator*(const_reference left, const matrix& right) {
+    return matrix_impl::make_scaled(right, left);
   }
 };
+
+namespace matrix_impl {
+template <class T, class Allocator>
+matrix<T, Allocator> multiply(matrix_view<const T> left, matrix_view<const T> right, const Allocator& alloc) {
+  assert(left.cols() == right.rows());
+  matrix<T, Allocator> result(left.rows(), right.cols(), matrix_uninitialized, alloc);
+  if constexpr (gemm_value<T>) {
+    if (!result.empty()) {
+      parallel_gemm(left.rows(), right.cols(), left.cols(), left.data(), left.stride(), right.data(), right.stride(),
+                    result.data(), result.cols());
+    }
+  } else {
+    for (size_t i = 0; i < left.rows(); ++i) {
+      for (size_t j = 0; j < right.cols(); ++j) {
+        result(i, j) = std::inner_product(left.row_begin(i), left.row_end(i), right.col_begin(j), T{});
+      }
+    }
+  }
+  return result;
+}
+} // namespace matrix_impl
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "aligned_allocator.h"
+
+#include <cstddef>
+
+template <class T, class Allocator = aligned_allocator<T>>
+class matrix;
+
+template <class T, size_t Rows, size_t Cols>
+class static_matrix;
+
+template <class T>
+class matrix_view;
+
+template <class T>
+class transposed_view;
+
+// tag for constructors that leave trivially default constructible elements uninitialized
+struct matrix_uninitialized_t {
+  explicit matrix_uninitialized_t() = default;
+};
+
+inline constexpr matrix_uninitialized_t matrix_uninitialized{};
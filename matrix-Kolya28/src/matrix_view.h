@@ -0,0 +1,250 @@
+#pragma once
+
+#include "col_iterator.h"
+#include "expression.h"
+#include "matrix_fwd.h"
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+// Non-owning view of a rows x cols block of a row-major matrix with consecutive rows stride elements apart, such
+// as a whole matrix or a submatrix of it. Like std::span, copies refer to the same elements and constness is
+// shallow, matrix_view<const T> gives read-only access. Assignments write through to the viewed elements.
+// A view must not outlive the matrix it refers to.
+template <class T>
+class matrix_view : matrix_impl::operand_base {
+public:
+  using value_type = std::remove_const_t<T>;
+  using element_type = T;
+
+  using reference = element_type&;
+  using pointer = element_type*;
+
+  using row_iterator = pointer;
+  using col_iterator = matrix_impl::col_iterator<element_type>;
+
+private:
+  pointer _data = nullptr;
+  size_t _rows = 0;
+  size_t _cols = 0;
+  size_t _stride = 0;
+
+public:
+  matrix_view() = default;
+
+  matrix_view(pointer data, size_t rows, size_t cols, size_t stride)
+      : _data(data),
+        _rows(rows),
+        _cols(cols),
+        _stride(stride) {
+    assert(cols <= stride && "Stride should be at least the number of columns");
+  }
+
+  template <class Allocator>
+  matrix_view(matrix<value_type, Allocator>& m) : matrix_view(m.data(), m.rows(), m.cols(), m.cols()) {}
+
+  template <class Allocator>
+  requires std::is_const_v<element_type>
+  matrix_view(const matrix<value_type, Allocator>& m) : matrix_view(m.data(), m.rows(), m.cols(), m.cols()) {}
+
+  template <class U>
+  requires std::is_same_v<const U, element_type> && (!std::is_same_v<U, element_type>)
+  matrix_view(const matrix_view<U>& other) : matrix_view(other.data(), other.rows(), other.cols(), other.stride()) {}
+
+  matrix_view(const matrix_view&) = default;
+
+  // copies the elements of other into the viewed ones
+  matrix_view& operator=(const matrix_view& other)
+  requires(!std::is_const_v<element_type>)
+  {
+    return assign(other);
+  }
+
+  template <matrix_impl::operand M>
+  requires(!std::is_const_v<element_type>) && std::is_same_v<typename M::value_type, value_type>
+  matrix_view& operator=(const M& other) {
+    return assign(other);
+  }
+
+  // Iterators
+
+  row_iterator row_begin(size_t row) const {
+    assert(row < rows());
+    return data() + row * stride();
+  }
+
+  row_iterator row_end(size_t row) const {
+    return row_begin(row) + cols();
+  }
+
+  col_iterator col_begin(size_t col) const {
+    assert(col < cols());
+    return col_iterator(data(), 0, col, stride());
+  }
+
+  col_iterator col_end(size_t col) const {
+    assert(col < cols());
+    return col_iterator(data(), rows(), col, stride());
+  }
+
+  // Size
+
+  size_t rows() const noexcept {
+    return _rows;
+  }
+
+  size_t cols() const noexcept {
+    return _cols;
+  }
+
+  size_t size() const noexcept {
+    return rows() * cols();
+  }
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  // elements between the starts of consecutive rows
+  size_t stride() const noexcept {
+    return _stride;
+  }
+
+  // Elements access
+
+  reference operator()(size_t row, size_t col) const {
+    return row_begin(row)[col];
+  }
+
+  pointer data() const noexcept {
+    return _data;
+  }
+
+  // Views
+
+  matrix_view submatrix(size_t row, size_t col, size_t height, size_t width) const {
+    assert(row + height <= rows() && col + width <= cols() && "Submatrix should be inside the matrix");
+    return {data() + row * stride() + col, height, width, stride()};
+  }
+
+  transposed_view<element_type> transpose_view() const {
+    return transposed_view<element_type>(*this);
+  }
+
+  // Arithmetic operations
+
+  template <matrix_impl::operand M>
+  requires(!std::is_const_v<element_type>) && std::is_same_v<typename M::value_type, value_type>
+  matrix_view& operator+=(const M& other) {
+    return assign(*this + other);
+  }
+
+  template <matrix_impl::operand M>
+  requires(!std::is_const_v<element_type>) && std::is_same_v<typename M::value_type, value_type>
+  matrix_view& operator-=(const M& other) {
+    return assign(*this - other);
+  }
+
+  matrix_view& operator*=(const value_type& factor)
+  requires(!std::is_const_v<element_type>)
+  {
+    return assign(*this * factor);
+  }
+
+  template <matrix_impl::operand M>
+  requires(!std::is_const_v<element_type>) && std::is_same_v<typename M::value_type, value_type>
+  matrix_view& add_scaled(const M& other, const value_type& factor) {
+    return assign(*this + other * factor);
+  }
+
+private:
+  // evaluates other in a single pass, through a temporary when it reads elements that are written before
+  template <matrix_impl::operand M>
+  matrix_view& assign(const M& other) {
+    auto e = matrix_impl::node(other);
+    assert(cols() == e.cols() && rows() == e.rows() && "Matrices should have equal dimensions");
+    if (e.aliases(data(), stride())) {
+      matrix<value_type> copy(e);
+      matrix_impl::assign(matrix_impl::node(copy), data(), stride());
+    } else {
+      matrix_impl::assign(e, data(), stride());
+    }
+    return *this;
+  }
+};
+
+// Lazy transpose of a view, element (row, col) is element (col, row) of the viewed block and no elements are
+// copied. Its rows are traversed with the column iterators of the block and vice versa.
+template <class T>
+class transposed_view : matrix_impl::operand_base {
+public:
+  using value_type = std::remove_const_t<T>;
+  using element_type = T;
+
+  using reference = element_type&;
+  using pointer = element_type*;
+
+  using row_iterator = matrix_impl::col_iterator<element_type>;
+  using col_iterator = pointer;
+
+private:
+  matrix_view<element_type> _base;
+
+public:
+  transposed_view() = default;
+
+  explicit transposed_view(const matrix_view<element_type>& base) : _base(base) {}
+
+  template <class U>
+  requires std::is_same_v<const U, element_type> && (!std::is_same_v<U, element_type>)
+  transposed_view(const transposed_view<U>& other) : _base(other.transpose_view()) {}
+
+  // Iterators
+
+  row_iterator row_begin(size_t row) const {
+    return _base.col_begin(row);
+  }
+
+  row_iterator row_end(size_t row) const {
+    return _base.col_end(row);
+  }
+
+  col_iterator col_begin(size_t col) const {
+    return _base.row_begin(col);
+  }
+
+  col_iterator col_end(size_t col) const {
+    return _base.row_end(col);
+  }
+
+  // Size
+
+  size_t rows() const noexcept {
+    return _base.cols();
+  }
+
+  size_t cols() const noexcept {
+    return _base.rows();
+  }
+
+  size_t size() const noexcept {
+    return _base.size();
+  }
+
+  bool empty() const noexcept {
+    return _base.empty();
+  }
+
+  // Elements access
+
+  reference operator()(size_t row, size_t col) const {
+    return _base(col, row);
+  }
+
+  // Views
+
+  const matrix_view<element_type>& transpose_view() const noexcept {
+    return _base;
+  }
+};
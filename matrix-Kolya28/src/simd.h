@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MATRIX_SIMD 1
+#define MATRIX_ALWAYS_INLINE [[gnu::always_inline]] inline
+#else
+#define MATRIX_SIMD 0
+#define MATRIX_ALWAYS_INLINE inline
+#endif
+
+#if MATRIX_SIMD && defined(__x86_64__)
+#define MATRIX_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define MATRIX_SIMD_X86 0
+#endif
+
+namespace matrix_impl::simd {
+// element types with vector kernels, everything else goes through the scalar loops
+template <class T>
+concept value = bool(MATRIX_SIMD) &&
+                (std::is_same_v<T, float> || std::is_same_v<T, double> || std::is_same_v<T, std::int32_t>);
+
+#if MATRIX_SIMD
+template <class T, size_t Bytes>
+struct batch_of {
+  typedef T type __attribute__((vector_size(Bytes)));
+};
+
+template <class T, size_t Bytes>
+using batch = typename batch_of<T, Bytes>::type;
+
+// loads and stores of count elements, the last partially filled batch of a range is zero padded
+template <class V, class T>
+MATRIX_ALWAYS_INLINE void load(V& v, const T* p, size_t count) {
+  if (count == sizeof(V) / sizeof(T)) {
+    std::memcpy(&v, p, sizeof(V));
+  } else {
+    v = V{};
+    std::memcpy(&v, p, count * sizeof(T));
+  }
+}
+
+template <class V, class T>
+MATRIX_ALWAYS_INLINE void store(const V& v, T* p, size_t count) {
+  std::memcpy(p, &v, std::min(sizeof(V), count * sizeof(T)));
+}
+
+#if MATRIX_SIMD_X86
+// comparisons are ordered-not-equal, so that NaN != NaN and -0.0 == 0.0 as for scalars
+[[gnu::target("avx512f")]] inline bool equal_avx512(const float* a, const float* b, size_t n) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    if (_mm512_cmp_ps_mask(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), _CMP_NEQ_UQ) != 0) {
+      return false;
+    }
+  }
+  __mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+  return _mm512_mask_cmp_ps_mask(tail, _mm512_maskz_loadu_ps(tail, a + i), _mm512_maskz_loadu_ps(tail, b + i),
+                                 _CMP_NEQ_UQ) == 0;
+}
+
+[[gnu::target("avx512f")]] inline bool equal_avx512(const double* a, const double* b, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    if (_mm512_cmp_pd_mask(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), _CMP_NEQ_UQ) != 0) {
+      return false;
+    }
+  }
+  __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+  return _mm512_mask_cmp_pd_mask(tail, _mm512_maskz_loadu_pd(tail, a + i), _mm512_maskz_loadu_pd(tail, b + i),
+                                 _CMP_NEQ_UQ) == 0;
+}
+
+[[gnu::target("avx2")]] inline bool equal_avx2(const float* a, const float* b, size_t n) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    if (_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), _CMP_NEQ_UQ)) != 0) {
+      return false;
+    }
+  }
+  return std::equal(a + i, a + n, b + i);
+}
+
+[[gnu::target("avx2")]] inline bool equal_avx2(const double* a, const double* b, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    if (_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _CMP_NEQ_UQ)) != 0) {
+      return false;
+    }
+  }
+  return std::equal(a + i, a + n, b + i);
+}
+
+inline bool equal_sse2(const float* a, const float* b, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    if (_mm_movemask_ps(_mm_cmpneq_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))) != 0) {
+      return false;
+    }
+  }
+  return std::equal(a + i, a + n, b + i);
+}
+
+inline bool equal_sse2(const double* a, const double* b, size_t n) {
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    if (_mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i))) != 0) {
+      return false;
+    }
+  }
+  return std::equal(a + i, a + n, b + i);
+}
+#endif
+#endif
+
+enum class isa {
+  baseline, // SSE2 on x86-64, NEON on AArch64
+  avx2, // with FMA
+  avx512,
+};
+
+inline isa cpu_isa() noexcept {
+#if MATRIX_SIMD_X86
+  static const isa best = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return isa::avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      return isa::avx2;
+    }
+    return isa::baseline;
+  }();
+  return best;
+#else
+  return isa::baseline;
+#endif
+}
+
+template <class T>
+bool equal(const T* a, const T* b, size_t n) {
+  if constexpr (std::is_integral_v<T> && value<T>) {
+    return n == 0 || std::memcmp(a, b, n * sizeof(T)) == 0;
+  } else if constexpr (value<T> && MATRIX_SIMD_X86) {
+#if MATRIX_SIMD_X86
+    switch (cpu_isa()) {
+    case isa::avx512:
+      return equal_avx512(a, b, n);
+    case isa::avx2:
+      return equal_avx2(a, b, n);
+    case isa::baseline:
+      break;
+    }
+    return equal_sse2(a, b, n);
+#endif
+  } else {
+    return std::equal(a, a + n, b);
+  }
+}
+} // namespace matrix_impl::simd
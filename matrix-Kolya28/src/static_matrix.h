@@ -0,0 +1,244 @@
+#pragma once
+
+#include "col_iterator.h"
+#include "matrix.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+namespace matrix_impl {
+// the largest power of two dividing the storage size, up to a cache line, so that alignment never adds padding
+template <class T, size_t Size, size_t Bytes = Size * sizeof(T)>
+constexpr size_t static_alignment = std::max(alignof(T), std::min<size_t>(Bytes & (~Bytes + 1), 64));
+
+// products up to this number of multiplications are unrolled completely
+constexpr size_t STATIC_UNROLL_LIMIT = 512;
+} // namespace matrix_impl
+
+// Matrix with dimensions known at compile time. Elements are stored inline, so it never allocates and is usable
+// in constant expressions. Iterators have the same types as for matrix<T>.
+template <class T, size_t Rows, size_t Cols>
+class static_matrix {
+  static_assert(Rows > 0 && Cols > 0, "Dimensions of static_matrix should be positive");
+
+public:
+  using value_type = T;
+
+  using reference = value_type&;
+  using const_reference = const value_type&;
+
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+  using row_iterator = pointer;
+  using const_row_iterator = const_pointer;
+
+  using col_iterator = matrix_impl::col_iterator<value_type>;
+  using const_col_iterator = matrix_impl::col_iterator<const value_type>;
+
+private:
+  alignas(matrix_impl::static_alignment<T, Rows * Cols>) value_type _data[Rows * Cols]{};
+
+public:
+  constexpr static_matrix() = default;
+
+  constexpr static_matrix(const value_type (&init)[Rows][Cols]) {
+    for (size_t i = 0; i < Rows; ++i) {
+      for (size_t j = 0; j < Cols; ++j) {
+        _data[i * Cols + j] = init[i][j];
+      }
+    }
+  }
+
+  explicit static_matrix(const matrix<T>& other) {
+    assert(other.rows() == Rows && other.cols() == Cols && "Matrices should have equal dimensions");
+    std::copy(other.begin(), other.end(), begin());
+  }
+
+  operator matrix<T>() const {
+    matrix<T> result(Rows, Cols, matrix_uninitialized);
+    std::copy(begin(), end(), result.begin());
+    return result;
+  }
+
+  // Element access
+
+  constexpr reference operator()(size_t row, size_t col) {
+    assert(row < Rows && col < Cols);
+    return _data[row * Cols + col];
+  }
+
+  constexpr const_reference operator()(size_t row, size_t col) const {
+    assert(row < Rows && col < Cols);
+    return _data[row * Cols + col];
+  }
+
+  constexpr pointer data() noexcept {
+    return _data;
+  }
+
+  constexpr const_pointer data() const noexcept {
+    return _data;
+  }
+
+  // Iterators
+
+  constexpr iterator begin() noexcept {
+    return data();
+  }
+
+  constexpr const_iterator begin() const noexcept {
+    return data();
+  }
+
+  constexpr iterator end() noexcept {
+    return data() + size();
+  }
+
+  constexpr const_iterator end() const noexcept {
+    return data() + size();
+  }
+
+  constexpr row_iterator row_begin(size_t row) {
+    assert(row < Rows);
+    return data() + row * Cols;
+  }
+
+  constexpr const_row_iterator row_begin(size_t row) const {
+    assert(row < Rows);
+    return data() + row * Cols;
+  }
+
+  constexpr row_iterator row_end(size_t row) {
+    return row_begin(row) + Cols;
+  }
+
+  constexpr const_row_iterator row_end(size_t row) const {
+    return row_begin(row) + Cols;
+  }
+
+  constexpr col_iterator col_begin(size_t col) {
+    assert(col < Cols);
+    return col_iterator(begin(), 0, col, Cols);
+  }
+
+  constexpr const_col_iterator col_begin(size_t col) const {
+    assert(col < Cols);
+    return const_col_iterator(begin(), 0, col, Cols);
+  }
+
+  constexpr col_iterator col_end(size_t col) {
+    assert(col < Cols);
+    return col_iterator(begin(), Rows, col, Cols);
+  }
+
+  constexpr const_col_iterator col_end(size_t col) const {
+    assert(col < Cols);
+    return const_col_iterator(begin(), Rows, col, Cols);
+  }
+
+  // Size
+
+  static constexpr size_t rows() noexcept {
+    return Rows;
+  }
+
+  static constexpr size_t cols() noexcept {
+    return Cols;
+  }
+
+  static constexpr size_t size() noexcept {
+    return Rows * Cols;
+  }
+
+  static constexpr bool empty() noexcept {
+    return false;
+  }
+
+  // Comparison
+
+  friend constexpr bool operator==(const static_matrix& left, const static_matrix& right) = default;
+
+  // Arithmetic operations
+
+  constexpr static_matrix& operator+=(const static_matrix& other) {
+    for (size_t i = 0; i < size(); ++i) {
+      _data[i] = _data[i] + other._data[i];
+    }
+    return *this;
+  }
+
+  constexpr static_matrix& operator-=(const static_matrix& other) {
+    for (size_t i = 0; i < size(); ++i) {
+      _data[i] = _data[i] - other._data[i];
+    }
+    return *this;
+  }
+
+  constexpr static_matrix& operator*=(const static_matrix<T, Cols, Cols>& other) {
+    return *this = *this * other;
+  }
+
+  constexpr static_matrix& operator*=(const_reference factor) {
+    for (size_t i = 0; i < size(); ++i) {
+      _data[i] = _data[i] * factor;
+    }
+    return *this;
+  }
+
+  friend constexpr static_matrix operator+(const static_matrix& left, const static_matrix& right) {
+    return static_matrix(left) += right;
+  }
+
+  friend constexpr static_matrix operator-(const static_matrix& left, const static_matrix& right) {
+    return static_matrix(left) -= right;
+  }
+
+  friend constexpr static_matrix operator*(const static_matrix& left, const_reference right) {
+    return static_matrix(left) *= right;
+  }
+
+  friend constexpr static_matrix operator*(const_reference left, const static_matrix& right) {
+    return operator*(right, left);
+  }
+};
+
+namespace matrix_impl {
+template <size_t Row, size_t Col, class L, class R, size_t... K>
+constexpr auto static_dot(const L& left, const R& right, std::index_sequence<K...>) {
+  return (... + (left(Row, K) * right(K, Col)));
+}
+
+template <class T, size_t Rows, size_t Inner, size_t Cols, size_t... Index>
+constexpr void static_multiply(const static_matrix<T, Rows, Inner>& left, const static_matrix<T, Inner, Cols>& right,
+                               static_matrix<T, Rows, Cols>& result, std::index_sequence<Index...>) {
+  ((result(Index / Cols, Index % Cols) =
+        static_dot<Index / Cols, Index % Cols>(left, right, std::make_index_sequence<Inner>())),
+   ...);
+}
+} // namespace matrix_impl
+
+template <class T, size_t Rows, size_t Inner, size_t Cols>
+constexpr static_matrix<T, Rows, Cols> operator*(const static_matrix<T, Rows, Inner>& left,
+                                                 const static_matrix<T, Inner, Cols>& right) {
+  static_matrix<T, Rows, Cols> result;
+  if constexpr (Rows * Inner * Cols <= matrix_impl::STATIC_UNROLL_LIMIT) {
+    matrix_impl::static_multiply(left, right, result, std::make_index_sequence<Rows * Cols>());
+  } else {
+    for (size_t i = 0; i < Rows; ++i) {
+      for (size_t j = 0; j < Cols; ++j) {
+        T sum = left(i, 0) * right(0, j);
+        for (size_t k = 1; k < Inner; ++k) {
+          sum = sum + left(i, k) * right(k, j);
+        }
+        result(i, j) = sum;
+      }
+    }
+  }
+  return result;
+}
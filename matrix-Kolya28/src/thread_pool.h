@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace matrix_impl {
+class thread_pool {
+public:
+  // threads includes the calling thread, which takes part in every run
+  explicit thread_pool(size_t threads) {
+    for (size_t i = 1; i < threads; ++i) {
+      _workers.emplace_back([this] { work(); });
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard lock(_mutex);
+      _stopping = true;
+    }
+    _wake.notify_all();
+    for (std::thread& worker : _workers) {
+      worker.join();
+    }
+  }
+
+  size_t size() const noexcept {
+    return _workers.size() + 1;
+  }
+
+  // whether the current thread is running a task of a pool, the parallel operations started by a task go
+  // serial as its pool is busy with the outer run
+  static bool in_task() noexcept {
+    return _in_task;
+  }
+
+  // calls task(i) for every i in [0, count) and returns when all of them are done,
+  // rethrows the first exception thrown by a task, must not be called from a task
+  template <class Task>
+  void run(size_t count, const Task& task) {
+    std::lock_guard run_lock(_run_mutex);
+    {
+      std::lock_guard lock(_mutex);
+      _task = &task;
+      _invoke = [](const void* t, size_t i) { (*static_cast<const Task*>(t))(i); };
+      _count = count;
+      _next = 0;
+      _remaining = count;
+      _error = nullptr;
+      ++_generation;
+    }
+    _wake.notify_all();
+    execute();
+
+    std::unique_lock lock(_mutex);
+    _done.wait(lock, [this] { return _remaining == 0 && _active == 0; });
+    if (_error) {
+      std::rethrow_exception(std::exchange(_error, nullptr));
+    }
+  }
+
+private:
+  void execute() {
+    bool outer = std::exchange(_in_task, true);
+    for (size_t i; (i = _next.fetch_add(1)) < _count;) {
+      try {
+        _invoke(_task, i);
+      } catch (...) {
+        std::lock_guard lock(_mutex);
+        if (!_error) {
+          _error = std::current_exception();
+        }
+      }
+      if (_remaining.fetch_sub(1) == 1) {
+        std::lock_guard lock(_mutex);
+        _done.notify_all();
+      }
+    }
+    _in_task = outer;
+  }
+
+  void work() {
+    size_t seen = 0;
+    std::unique_lock lock(_mutex);
+    while (true) {
+      _wake.wait(lock, [&] { return _stopping || _generation != seen; });
+      if (_stopping) {
+        return;
+      }
+      seen = _generation;
+      // a late wake-up must not join a run that has already finished
+      if (_remaining == 0) {
+        continue;
+      }
+      ++_active;
+      lock.unlock();
+      execute();
+      lock.lock();
+      if (--_active == 0) {
+        _done.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> _workers;
+  std::mutex _run_mutex;
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _done;
+
+  const void* _task = nullptr;
+  void (*_invoke)(const void*, size_t) = nullptr;
+  size_t _count = 0;
+  std::atomic<size_t> _next = 0;
+  std::atomic<size_t> _remaining = 0;
+  size_t _active = 0;
+  size_t _generation = 0;
+  bool _stopping = false;
+  std::exception_ptr _error;
+
+  inline static thread_local bool _in_task = false;
+};
+
+inline std::unique_ptr<thread_pool>& shared_pool() {
+  static std::unique_ptr<thread_pool> pool;
+  return pool;
+}
+
+// splits [0, count) into ranges of at least grain items and calls task(first, last) for each of them,
+// on the shared pool when it is configured, there is more than one range and this is not a task of a pool
+template <class Task>
+void parallel_for(size_t count, size_t grain, const Task& task) {
+  thread_pool* pool = thread_pool::in_task() ? nullptr : shared_pool().get();
+  size_t chunks = pool == nullptr ? 1 : std::min(4 * pool->size(), count / std::max<size_t>(grain, 1));
+  if (chunks <= 1) {
+    if (count != 0) {
+      task(size_t{0}, count);
+    }
+    return;
+  }
+  pool->run(chunks, [&](size_t i) { task(count * i / chunks, count * (i + 1) / chunks); });
+}
+} // namespace matrix_impl
+
+// Number of threads used by operations on large matrices, including the calling one. The default of 1 keeps
+// everything serial. Must not be changed while another thread is running a matrix operation.
+inline void set_matrix_threads(size_t threads) {
+  matrix_impl::shared_pool().reset();
+  if (threads > 1) {
+    matrix_impl::shared_pool() = std::make_unique<matrix_impl::thread_pool>(threads);
+  }
+}
+
+inline size_t matrix_threads() noexcept {
+  const auto& pool = matrix_impl::shared_pool();
+  return pool ? pool->size() : 1;
+}
@@ -0,0 +1,198 @@
+#include "matrix.h"
+#include "test_helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+
+namespace {
+
+struct allocation_counters {
+  size_t allocations = 0;
+  size_t deallocations = 0;
+};
+
+// stateful allocator, allocators with different ids can't free each other's storage
+template <class T>
+class counting_allocator {
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::false_type;
+
+  counting_allocator(allocation_counters* counters, int id) noexcept : _counters(counters), _id(id) {}
+
+  template <class U>
+  counting_allocator(const counting_allocator<U>& other) noexcept : _counters(other.counters()), _id(other.id()) {}
+
+  T* allocate(size_t n) {
+    ++_counters->allocations;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    ++_counters->deallocations;
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  allocation_counters* counters() const noexcept {
+    return _counters;
+  }
+
+  int id() const noexcept {
+    return _id;
+  }
+
+  template <class U>
+  friend bool operator==(const counting_allocator& left, const counting_allocator<U>& right) noexcept {
+    return left.id() == right.id();
+  }
+
+private:
+  allocation_counters* _counters;
+  int _id;
+};
+
+bool is_aligned(const void* p, size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+} // namespace
+
+TEST(allocator_test, alignment) {
+  for (size_t n : {1, 3, 17, 100}) {
+    EXPECT_TRUE(is_aligned(matrix<char>(n, n).data(), MATRIX_ALIGNMENT));
+    EXPECT_TRUE(is_aligned(matrix<float>(n, n + 1).data(), MATRIX_ALIGNMENT));
+    EXPECT_TRUE(is_aligned(matrix<double>(n, n, matrix_uninitialized).data(), MATRIX_ALIGNMENT));
+  }
+
+  matrix<float> a(5, 7);
+  EXPECT_TRUE(is_aligned(matrix<float>(a).data(), MATRIX_ALIGNMENT));
+  EXPECT_TRUE(is_aligned(matrix<float>(a + a).data(), MATRIX_ALIGNMENT));
+  EXPECT_TRUE(is_aligned(matrix<float>(a * a.transpose_view()).data(), MATRIX_ALIGNMENT));
+
+  matrix<int, aligned_allocator<int, 256>> b(3, 3);
+  EXPECT_TRUE(is_aligned(b.data(), 256));
+}
+
+TEST(allocator_test, zero_initialized) {
+  matrix<double> a(20, 30);
+  for (double x : a) {
+    EXPECT_EQ(0, x);
+  }
+}
+
+TEST(allocator_test, uninitialized_ctor) {
+  matrix<int> a(4, 5, matrix_uninitialized);
+  EXPECT_EQ(4, a.rows());
+  EXPECT_EQ(5, a.cols());
+  fill(a);
+  for (size_t i = 0; i < a.rows(); ++i) {
+    for (size_t j = 0; j < a.cols(); ++j) {
+      EXPECT_EQ(elem(i, j), a(i, j));
+    }
+  }
+
+  expect_empty(matrix<int>(0, 5, matrix_uninitialized));
+
+  // elements that aren't trivial are still default constructed
+  matrix<std::string> b(3, 3, matrix_uninitialized);
+  for (const std::string& s : b) {
+    EXPECT_TRUE(s.empty());
+  }
+}
+
+TEST(allocator_test, stateful_allocator) {
+  using allocator = counting_allocator<int>;
+  allocation_counters counters;
+
+  {
+    matrix<int, allocator> a(allocator(&counters, 1));
+    EXPECT_EQ(0, counters.allocations);
+    EXPECT_EQ(1, a.get_allocator().id());
+
+    matrix<int, allocator> b(3, 4, allocator(&counters, 1));
+    fill(b);
+    EXPECT_EQ(1, counters.allocations);
+
+    matrix<int, allocator> c = b;
+    EXPECT_EQ(2, counters.allocations);
+    EXPECT_EQ(1, c.get_allocator().id());
+    expect_equal(matrix<int>(b), c);
+
+    matrix<int, allocator> d = std::move(c);
+    EXPECT_EQ(2, counters.allocations);
+    EXPECT_EQ(nullptr, c.data());
+
+    matrix<int, allocator> e(b + d * 2, allocator(&counters, 2));
+    EXPECT_EQ(3, counters.allocations);
+    EXPECT_EQ(2, e.get_allocator().id());
+    expect_equal(matrix<int>(matrix<int>(b) * 3), e);
+
+    // the allocators don't propagate and aren't equal, so the elements are copied into storage of e
+    e = std::move(d);
+    EXPECT_EQ(4, counters.allocations);
+    EXPECT_EQ(2, e.get_allocator().id());
+    expect_equal(matrix<int>(b), e);
+
+    e = b;
+    EXPECT_EQ(5, counters.allocations);
+    EXPECT_EQ(2, e.get_allocator().id());
+
+    // products with other operands are allocated with the default allocator
+    EXPECT_TRUE((std::is_same_v<matrix<int>, decltype(b * b.transpose_view())>));
+  }
+  EXPECT_EQ(counters.allocations, counters.deallocations);
+}
+
+TEST(allocator_test, product_allocator) {
+  using allocator = counting_allocator<double>;
+  allocation_counters counters;
+
+  matrix<double, allocator> a(3, 4, allocator(&counters, 7));
+  matrix<double, allocator> b(4, 2, allocator(&counters, 7));
+  fill(a);
+  fill(b);
+
+  auto c = a * b;
+  EXPECT_TRUE((std::is_same_v<matrix<double, allocator>, decltype(c)>));
+  EXPECT_EQ(7, c.get_allocator().id());
+  expect_equal(matrix<double>(a) * matrix<double>(b), c);
+}
+
+TEST(allocator_test, mixed_allocators) {
+  using allocator = counting_allocator<int>;
+  allocation_counters counters;
+
+  matrix<int> a(2, 2);
+  fill(a);
+  matrix<int, allocator> b(a, allocator(&counters, 1));
+
+  expect_equal(matrix<int>(a * 2), a + b);
+  expect_equal(a * a, a * b);
+  EXPECT_EQ(1, counters.allocations);
+}
+
+TEST(allocator_test, memory_resource) {
+  alignas(64) std::byte buffer[4096];
+  std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+  using pmr_matrix = matrix<double, std::pmr::polymorphic_allocator<double>>;
+
+  pmr_matrix a(8, 8, &resource);
+  fill(a);
+  pmr_matrix b(a + a, &resource);
+  EXPECT_GE(static_cast<const void*>(b.data()), static_cast<const void*>(buffer));
+  EXPECT_LT(static_cast<const void*>(b.data()), static_cast<const void*>(buffer + sizeof(buffer)));
+  expect_equal(matrix<double>(a + a), b);
+}
+
+TEST(allocator_test, traits) {
+  EXPECT_TRUE((std::is_same_v<aligned_allocator<int>, matrix<int>::allocator_type>));
+  EXPECT_EQ(3 * sizeof(size_t), sizeof(matrix<int>));
+  EXPECT_TRUE(std::is_nothrow_move_constructible_v<matrix<int>>);
+  EXPECT_TRUE(std::is_nothrow_move_assignable_v<matrix<int>>);
+  EXPECT_FALSE((std::is_convertible_v<matrix_uninitialized_t, size_t>));
+}
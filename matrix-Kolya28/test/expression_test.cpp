@@ -0,0 +1,161 @@
+#include "matrix.h"
+#include "test_helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <complex>
+#include <type_traits>
+
+TEST(expression_test, lazy) {
+  matrix<int> a(2, 3);
+  matrix<int> b(2, 3);
+
+  EXPECT_FALSE((std::is_same_v<matrix<int>, decltype(a + b)>));
+  EXPECT_FALSE((std::is_same_v<matrix<int>, decltype(a - b * 2)>));
+  EXPECT_FALSE((std::is_same_v<matrix<int>, decltype(3 * (a + b))>));
+  EXPECT_TRUE((std::is_same_v<matrix<int>, decltype((a + b) * matrix<int>(3, 1))>));
+}
+
+TEST(expression_test, fused_chain) {
+  matrix<int> a({
+      {1, 2, 3},
+      {4, 5, 6},
+  });
+  const matrix<int> b({
+      {10, 20, 30},
+      {40, 50, 60},
+  });
+  const matrix<int> c({
+      {7, 7, 7},
+      {7, 7, 7},
+  });
+  const matrix<int> d({
+      {14, 35, 56},
+      {77, 98, 119},
+  });
+
+  expect_equal(d, a + b * 2 - c);
+  expect_equal(d, 2 * b - (c - a));
+  matrix<int> e = (a + b) * 2 - a - c * 1;
+  expect_equal(d, e);
+}
+
+TEST(expression_test, assign_in_place) {
+  const matrix<int> a({
+      {1, 2, 3},
+      {4, 5, 6},
+  });
+  const matrix<int> b({
+      {10, 20, 30},
+      {40, 50, 60},
+  });
+  const matrix<int> c({
+      {21, 42, 63},
+      {84, 105, 126},
+  });
+
+  matrix<int> d(2, 3);
+  const int* data = d.data();
+  d = a + b * 2;
+  EXPECT_EQ(data, d.data());
+  expect_equal(c, d);
+
+  d += a - a;
+  d -= b * 0;
+  EXPECT_EQ(data, d.data());
+  expect_equal(c, d);
+}
+
+TEST(expression_test, assign_reshape) {
+  const matrix<int> a({
+      {1, 2},
+      {3, 4},
+      {5, 6},
+  });
+  matrix<int> b(1, 1);
+
+  b = a * 2;
+  expect_equal(matrix<int>({
+                   {2, 4},
+                   {6, 8},
+                   {10, 12},
+               }),
+               b);
+}
+
+TEST(expression_test, aliasing) {
+  matrix<int> a({
+      {1, 2, 3},
+      {4, 5, 6},
+  });
+  const matrix<int> b({
+      {4, 8, 12},
+      {16, 20, 24},
+  });
+
+  a = a + a * 3;
+  expect_equal(b, a);
+}
+
+TEST(expression_test, mul_matrix) {
+  const matrix<int> a({
+      {1, 2},
+      {3, 4},
+  });
+  const matrix<int> b({
+      {1, 0},
+      {0, 1},
+  });
+
+  expect_equal(matrix<int>({
+                   {2, 2},
+                   {3, 5},
+               }),
+               (a + b) * b);
+  expect_equal(matrix<int>(a * 2), a * (b + b));
+  expect_equal(matrix<int>(a * 4), (a + a) * (b + b));
+
+  matrix<int> c = a;
+  c *= b * 3;
+  expect_equal(matrix<int>(a * 3), c);
+}
+
+TEST(expression_test, empty) {
+  matrix<int> a, b;
+  matrix<int> c = a + b * 2;
+  expect_empty(c);
+}
+
+TEST(expression_test, non_arithmetic) {
+  using complex = std::complex<double>;
+
+  matrix<complex> a({
+      {complex(1, 1), complex(0, 2)},
+  });
+  const matrix<complex> b({
+      {complex(2, 0), complex(1, -1)},
+  });
+
+  a.add_scaled(b - a, complex(0, 1));
+  expect_equal(matrix<complex>({
+                   {complex(2, 2), complex(3, 3)},
+               }),
+               a);
+}
+
+TEST(expression_test, long_chain) {
+  for (size_t cols : {1, 5, 16, 17, 100}) {
+    matrix<float> a(7, cols);
+    matrix<float> b(7, cols);
+    fill(a);
+    fill(b);
+
+    matrix<float> c = a * 0.5f + b - a * 2.0f + b * 0.25f;
+    for (size_t i = 0; i < a.rows(); ++i) {
+      for (size_t j = 0; j < a.cols(); ++j) {
+        float x = static_cast<float>(elem(i, j));
+        EXPECT_EQ(x * 0.5f + x - x * 2.0f + x * 0.25f, c(i, j));
+      }
+    }
+  }
+}
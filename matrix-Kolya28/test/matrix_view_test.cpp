@@ -0,0 +1,292 @@
+#include "matrix.h"
+#include "test_helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <complex>
+#include <numeric>
+#include <string>
+#include <type_traits>
+
+TEST(matrix_view_test, view) {
+  matrix<int> a(3, 4);
+  fill(a);
+
+  matrix_view<int> v = a.view();
+  EXPECT_EQ(a.data(), v.data());
+  EXPECT_EQ(3, v.rows());
+  EXPECT_EQ(4, v.cols());
+  EXPECT_EQ(4, v.stride());
+  EXPECT_EQ(12, v.size());
+  EXPECT_FALSE(v.empty());
+
+  v(1, 2) = -1;
+  EXPECT_EQ(-1, a(1, 2));
+  expect_equal(a, v);
+
+  const matrix<int>& c = a;
+  EXPECT_TRUE((std::is_same_v<matrix_view<const int>, decltype(c.view())>));
+  matrix_view<const int> cv = v;
+  EXPECT_EQ(a.data(), cv.data());
+  EXPECT_TRUE(matrix_view<int>().empty());
+}
+
+TEST(matrix_view_test, submatrix) {
+  matrix<int> a(5, 6);
+  fill(a);
+
+  matrix_view<int> s = a.submatrix(1, 2, 3, 2);
+  EXPECT_EQ(3, s.rows());
+  EXPECT_EQ(2, s.cols());
+  EXPECT_EQ(6, s.stride());
+  EXPECT_EQ(&a(1, 2), s.data());
+  for (size_t i = 0; i < s.rows(); ++i) {
+    for (size_t j = 0; j < s.cols(); ++j) {
+      EXPECT_EQ(elem(i + 1, j + 2), s(i, j));
+    }
+  }
+
+  matrix_view<int> nested = s.submatrix(1, 1, 2, 1);
+  EXPECT_EQ(&a(2, 3), nested.data());
+  nested(1, 0) = -1;
+  EXPECT_EQ(-1, a(3, 3));
+
+  EXPECT_TRUE(a.submatrix(2, 3, 0, 0).empty());
+}
+
+TEST(matrix_view_test, iterators) {
+  matrix<int> a(4, 5);
+  fill(a);
+  matrix_view<const int> s = std::as_const(a).submatrix(1, 1, 3, 3);
+
+  EXPECT_TRUE(std::equal(s.row_begin(1), s.row_end(1), a.row_begin(2) + 1));
+  EXPECT_EQ(3, s.col_end(0) - s.col_begin(0));
+  for (size_t j = 0; j < s.cols(); ++j) {
+    EXPECT_TRUE(std::equal(s.col_begin(j), s.col_end(j), a.col_begin(j + 1) + 1));
+  }
+
+  matrix_view<int> w = a.submatrix(0, 2, 4, 2);
+  std::fill(w.col_begin(1), w.col_end(1), 0);
+  for (size_t i = 0; i < a.rows(); ++i) {
+    EXPECT_EQ(0, a(i, 3));
+    EXPECT_EQ(elem(i, 4), a(i, 4));
+  }
+
+  matrix_view<const int> corner = std::as_const(a).submatrix(2, 3, 2, 2);
+  EXPECT_EQ(corner.col_begin(1) + 2, corner.col_end(1));
+  EXPECT_EQ(&a(3, 4), &*std::prev(corner.col_end(1)));
+  EXPECT_EQ(a(3, 3), corner.col_end(0)[-1]);
+}
+
+TEST(matrix_view_test, transpose_view) {
+  matrix<int> a(2, 3);
+  fill(a);
+
+  transposed_view<int> t = a.transpose_view();
+  EXPECT_EQ(3, t.rows());
+  EXPECT_EQ(2, t.cols());
+  for (size_t i = 0; i < t.rows(); ++i) {
+    for (size_t j = 0; j < t.cols(); ++j) {
+      EXPECT_EQ(a(j, i), t(i, j));
+    }
+  }
+  EXPECT_TRUE(std::equal(t.row_begin(2), t.row_end(2), a.col_begin(2)));
+  EXPECT_TRUE(std::equal(t.col_begin(1), t.col_end(1), a.row_begin(1)));
+
+  t(2, 0) = -1;
+  EXPECT_EQ(-1, a(0, 2));
+  EXPECT_EQ(a.data(), t.transpose_view().data());
+
+  matrix<int> b = t;
+  EXPECT_EQ(3, b.rows());
+  EXPECT_EQ(2, b.cols());
+  for (size_t i = 0; i < b.rows(); ++i) {
+    for (size_t j = 0; j < b.cols(); ++j) {
+      EXPECT_EQ(a(j, i), b(i, j));
+    }
+  }
+}
+
+TEST(matrix_view_test, transpose_many_cols) {
+  matrix<float> a(37, 19);
+  fill(a);
+  matrix<float> t = a.submatrix(1, 2, 35, 17).transpose_view() * 2.0f;
+  ASSERT_EQ(17, t.rows());
+  ASSERT_EQ(35, t.cols());
+  for (size_t i = 0; i < t.rows(); ++i) {
+    for (size_t j = 0; j < t.cols(); ++j) {
+      EXPECT_EQ(a(j + 1, i + 2) * 2, t(i, j));
+    }
+  }
+}
+
+TEST(matrix_view_test, transpose_in_place) {
+  matrix<double> a(33, 33);
+  fill(a);
+  const matrix<double> b = a;
+
+  a = a.transpose_view();
+  for (size_t i = 0; i < a.rows(); ++i) {
+    for (size_t j = 0; j < a.cols(); ++j) {
+      EXPECT_EQ(b(j, i), a(i, j));
+    }
+  }
+
+  a += a.transpose_view();
+  expect_equal(matrix<double>(b + b.transpose_view()), a);
+}
+
+TEST(matrix_view_test, arithmetic) {
+  matrix<int> a(4, 4);
+  fill(a);
+  const matrix<int> b = a;
+
+  matrix<int> sum = a.submatrix(0, 0, 2, 2) + a.submatrix(2, 2, 2, 2) * 2;
+  ASSERT_EQ(2, sum.rows());
+  ASSERT_EQ(2, sum.cols());
+  for (size_t i = 0; i < 2; ++i) {
+    for (size_t j = 0; j < 2; ++j) {
+      EXPECT_EQ(elem(i, j) + 2 * elem(i + 2, j + 2), sum(i, j));
+    }
+  }
+
+  matrix<int> c(2, 2);
+  fill(c);
+  a.submatrix(1, 1, 2, 2) -= c + c;
+  a.submatrix(0, 0, 1, 4) *= 3;
+  a.submatrix(3, 0, 1, 2).add_scaled(c.submatrix(0, 0, 1, 2), 10);
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      int expected = b(i, j);
+      if (i >= 1 && i < 3 && j >= 1 && j < 3) {
+        expected -= 2 * c(i - 1, j - 1);
+      }
+      if (i == 0) {
+        expected *= 3;
+      }
+      if (i == 3 && j < 2) {
+        expected += 10 * c(0, j);
+      }
+      EXPECT_EQ(expected, a(i, j)) << "  where i = " << i << ", j = " << j;
+    }
+  }
+
+  matrix<int> d = b;
+  d -= d.view();
+  expect_equal(matrix<int>(4, 4), d);
+}
+
+TEST(matrix_view_test, assign) {
+  matrix<int> a(3, 4);
+  matrix<int> b(2, 2);
+  fill(b);
+
+  a.submatrix(1, 2, 2, 2) = b;
+  a.submatrix(0, 0, 2, 2) = b * 2 + b;
+  for (size_t i = 0; i < 2; ++i) {
+    for (size_t j = 0; j < 2; ++j) {
+      EXPECT_EQ(b(i, j), a(i + 1, j + 2));
+      EXPECT_EQ(3 * b(i, j), a(i, j));
+    }
+  }
+  EXPECT_EQ(0, a(2, 0));
+  EXPECT_EQ(0, a(0, 3));
+
+  matrix_view<int> v = a.submatrix(0, 0, 2, 2);
+  matrix_view<int> w = v;
+  EXPECT_EQ(v.data(), w.data());
+  a.submatrix(1, 2, 2, 2) = v;
+  expect_equal(matrix<int>(v), matrix<int>(a.submatrix(1, 2, 2, 2)));
+
+  matrix<int> c = a.submatrix(1, 1, 2, 3);
+  EXPECT_EQ(2, c.rows());
+  EXPECT_EQ(3, c.cols());
+  c = b.view();
+  expect_equal(b, c);
+}
+
+TEST(matrix_view_test, overlapping_assign) {
+  matrix<int> a(5, 5);
+  fill(a);
+  const matrix<int> b = a;
+
+  a.submatrix(1, 1, 4, 4) = a.submatrix(0, 0, 4, 4);
+  for (size_t i = 1; i < 5; ++i) {
+    for (size_t j = 1; j < 5; ++j) {
+      EXPECT_EQ(b(i - 1, j - 1), a(i, j));
+    }
+  }
+
+  a = b;
+  a.submatrix(0, 0, 4, 4) += a.submatrix(1, 1, 4, 4);
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      EXPECT_EQ(b(i, j) + b(i + 1, j + 1), a(i, j));
+    }
+  }
+
+  a = b;
+  a.submatrix(0, 0, 5, 5) = a.transpose_view();
+  expect_equal(matrix<int>(b.transpose_view()), a);
+}
+
+TEST(matrix_view_test, mul) {
+  matrix<double> a(40, 50);
+  matrix<double> b(60, 70);
+  fill(a);
+  fill(b);
+
+  auto sa = a.submatrix(3, 5, 30, 40);
+  auto sb = b.submatrix(10, 20, 40, 30);
+  matrix<double> expected = matrix<double>(sa) * matrix<double>(sb);
+  ASSERT_EQ(30, expected.rows());
+  ASSERT_EQ(30, expected.cols());
+  expect_equal(expected, sa * sb);
+  expect_equal(expected, matrix<double>(sa) * sb);
+  expect_equal(expected, sa * matrix<double>(sb));
+
+  matrix<double> c(30, 40);
+  c = sb.transpose_view();
+  expect_equal(matrix<double>(sa) * matrix<double>(c.transpose_view()), sa * sb.transpose_view().transpose_view());
+  expect_equal(matrix<double>(c) * matrix<double>(sa.transpose_view()), c * sa.transpose_view());
+
+  matrix<double> sq = a.submatrix(0, 0, 30, 30);
+  sq *= sa * sb;
+  expect_equal(matrix<double>(a.submatrix(0, 0, 30, 30)) * expected, sq);
+}
+
+TEST(matrix_view_test, mul_non_arithmetic) {
+  using complex = std::complex<double>;
+
+  matrix<complex> a({
+      {complex(1, 1), complex(0, 2), complex(3, 0)},
+      {complex(2, 0), complex(1, -1), complex(0, 0)},
+  });
+  matrix<complex> expected({
+      {complex(0, 2) * complex(0, 2) + complex(3, 0) * complex(3, 0)},
+  });
+  expect_equal(expected, a.submatrix(0, 1, 1, 2) * a.submatrix(0, 1, 1, 2).transpose_view());
+}
+
+TEST(matrix_view_test, non_arithmetic) {
+  matrix<std::string> a(2, 3);
+  a(0, 1) = "a";
+  a(1, 2) = "b";
+
+  matrix<std::string> b = a.transpose_view();
+  EXPECT_EQ("a", b(1, 0));
+  EXPECT_EQ("b", b(2, 1));
+
+  a.submatrix(0, 0, 2, 2) = a.submatrix(0, 1, 2, 2) + a.submatrix(0, 1, 2, 2);
+  EXPECT_EQ("aa", a(0, 0));
+  EXPECT_EQ("bb", a(1, 1));
+}
+
+TEST(matrix_view_test, traits) {
+  EXPECT_TRUE((std::is_copy_assignable_v<matrix_view<int>>));
+  EXPECT_FALSE((std::is_copy_assignable_v<matrix_view<const int>>));
+  EXPECT_FALSE((std::is_convertible_v<matrix_view<const int>, matrix_view<int>>));
+  EXPECT_TRUE((std::is_convertible_v<transposed_view<int>, transposed_view<const int>>));
+  EXPECT_FALSE((std::is_constructible_v<matrix_view<int>, const matrix<int>&>));
+}
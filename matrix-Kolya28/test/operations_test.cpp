@@ -3,7 +3,10 @@
 
 #include <gtest/gtest.h>
 
+#include <complex>
+#include <limits>
 #include <numeric>
+#include <tuple>
 
 TEST(operations_test, element_access) {
   matrix<int> a(2, 3);
@@ -384,6 +387,62 @@ TEST(operations_test, mul_return_value) {
   expect_equal(c, a);
 }
 
+namespace {
+template <class T>
+matrix<T> naive_mul(const matrix<T>& a, const matrix<T>& b) {
+  matrix<T> c(a.rows(), b.cols());
+  for (size_t i = 0; i < a.rows(); ++i) {
+    for (size_t j = 0; j < b.cols(); ++j) {
+      for (size_t k = 0; k < a.cols(); ++k) {
+        c(i, j) += a(i, k) * b(k, j);
+      }
+    }
+  }
+  return c;
+}
+
+template <class T>
+void fill_small(matrix<T>& a, size_t seed) {
+  for (size_t i = 0; i < a.rows(); ++i) {
+    for (size_t j = 0; j < a.cols(); ++j) {
+      a(i, j) = static_cast<T>(static_cast<int>((i * 31 + j * 17 + seed) % 19) - 9);
+    }
+  }
+}
+} // namespace
+
+TEST(operations_test, mul_large) {
+  for (auto [m, k, n] : {std::tuple<size_t, size_t, size_t>{1, 1, 1}, {5, 300, 3}, {131, 257, 77}, {9, 20, 2100}}) {
+    matrix<int> a(m, k);
+    matrix<int> b(k, n);
+    fill_small(a, 1);
+    fill_small(b, 2);
+    expect_equal(naive_mul(a, b), a * b);
+
+    matrix<double> c(m, k);
+    matrix<double> d(k, n);
+    fill_small(c, 3);
+    fill_small(d, 4);
+    expect_equal(naive_mul(c, d), c * d);
+  }
+}
+
+TEST(operations_test, mul_non_arithmetic) {
+  matrix<std::complex<double>> a(7, 5);
+  matrix<std::complex<double>> b(5, 6);
+  for (size_t i = 0; i < a.rows(); ++i) {
+    for (size_t j = 0; j < a.cols(); ++j) {
+      a(i, j) = {static_cast<double>(elem(i, j)), 1};
+    }
+  }
+  for (size_t i = 0; i < b.rows(); ++i) {
+    for (size_t j = 0; j < b.cols(); ++j) {
+      b(i, j) = {1, static_cast<double>(elem(i, j))};
+    }
+  }
+  expect_equal(naive_mul(a, b), a * b);
+}
+
 TEST(operations_test, mul_scalar) {
   matrix<int> a({
       {1, 2, 3},
@@ -414,3 +473,78 @@ TEST(operations_test, mul_scalar_return_value) {
   (a *= 5) *= 2;
   expect_equal(b, a);
 }
+
+TEST(operations_test, add_scaled) {
+  matrix<int> a({
+      {1, 2, 3},
+      {4, 5, 6},
+  });
+  const matrix<int> b({
+      {10, 20, 30},
+      {40, 50, 60},
+  });
+  const matrix<int> c({
+      {31,  62,  93},
+      {124, 155, 186},
+  });
+
+  a.add_scaled(b, 3);
+  expect_equal(c, a);
+}
+
+namespace {
+template <class T>
+void expect_element_wise(size_t rows, size_t cols) {
+  matrix<T> a(rows, cols);
+  matrix<T> b(rows, cols);
+  fill(a);
+  fill(b);
+  b *= T(3);
+
+  matrix<T> sum = a + b;
+  matrix<T> difference = a - b;
+  matrix<T> scaled = a * T(5);
+  matrix<T> fused = b;
+  fused.add_scaled(a, T(2));
+  for (size_t i = 0; i < rows; ++i) {
+    for (size_t j = 0; j < cols; ++j) {
+      T x = T(elem(i, j));
+      EXPECT_EQ(x + x * T(3), sum(i, j));
+      EXPECT_EQ(x - x * T(3), difference(i, j));
+      EXPECT_EQ(x * T(5), scaled(i, j));
+      EXPECT_EQ(x * T(2) + x * T(3), fused(i, j));
+    }
+  }
+
+  matrix<T> copy = a;
+  EXPECT_TRUE(a == copy);
+  copy(rows - 1, cols - 1) += T(1);
+  EXPECT_FALSE(a == copy);
+}
+} // namespace
+
+TEST(operations_test, element_wise_tails) {
+  for (size_t cols : {1, 3, 7, 15, 16, 17, 33}) {
+    expect_element_wise<int>(3, cols);
+    expect_element_wise<float>(3, cols);
+    expect_element_wise<double>(3, cols);
+    expect_element_wise<long long>(3, cols);
+  }
+}
+
+TEST(operations_test, compare_floating) {
+  constexpr double NAN_VALUE = std::numeric_limits<double>::quiet_NaN();
+
+  matrix<double> a({
+      {1.0, 0.0},
+  });
+  matrix<double> b({
+      {1.0, -0.0},
+  });
+  matrix<double> c({
+      {1.0, NAN_VALUE},
+  });
+
+  EXPECT_TRUE(a == b);
+  EXPECT_FALSE(c == c);
+}
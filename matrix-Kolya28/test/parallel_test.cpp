@@ -0,0 +1,101 @@
+#include "matrix.h"
+#include "test_helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+class parallel_test : public ::testing::Test {
+protected:
+  void SetUp() override {
+    set_matrix_threads(4);
+  }
+
+  void TearDown() override {
+    set_matrix_threads(1);
+  }
+};
+
+template <class T>
+matrix<T> serial(const auto& operation) {
+  set_matrix_threads(1);
+  matrix<T> result = operation();
+  set_matrix_threads(4);
+  return result;
+}
+} // namespace
+
+TEST_F(parallel_test, threads) {
+  EXPECT_EQ(4, matrix_threads());
+  set_matrix_threads(0);
+  EXPECT_EQ(1, matrix_threads());
+}
+
+TEST_F(parallel_test, mul) {
+  matrix<double> a(203, 150);
+  matrix<double> b(150, 317);
+  fill(a);
+  fill(b);
+
+  matrix<double> expected = serial<double>([&] { return a * b; });
+  expect_equal(expected, a * b);
+}
+
+TEST_F(parallel_test, element_wise) {
+  matrix<int> a(700, 301);
+  matrix<int> b(700, 301);
+  fill(a);
+  fill(b);
+  b *= 3;
+
+  expect_equal(serial<int>([&] { return a + b; }), a + b);
+  expect_equal(serial<int>([&] { return a - b; }), a - b);
+  expect_equal(serial<int>([&] { return a * 7; }), a * 7);
+
+  matrix<int> copy = a;
+  expect_equal(a, copy);
+}
+
+TEST_F(parallel_test, exception) {
+  matrix_impl::thread_pool& pool = *matrix_impl::shared_pool();
+  EXPECT_THROW(pool.run(100, [](size_t i) {
+    if (i == 42) {
+      throw std::runtime_error("task failed");
+    }
+  }),
+               std::runtime_error);
+
+  size_t sum = 0;
+  std::mutex mutex;
+  pool.run(100, [&](size_t i) {
+    std::lock_guard lock(mutex);
+    sum += i;
+  });
+  EXPECT_EQ(4950, sum);
+}
+
+TEST_F(parallel_test, nested) {
+  // both the outer copy and the copies of the large elements are big enough to be split over the pool
+  matrix<matrix<double>> a(256, 512);
+  for (size_t i = 0; i < 8; ++i) {
+    a(i * 32, i * 64) = matrix<double>(300, 300);
+    fill(a(i * 32, i * 64));
+  }
+
+  matrix<matrix<double>> copy = a;
+  for (size_t i = 0; i < 8; ++i) {
+    expect_equal(a(i * 32, i * 64), copy(i * 32, i * 64));
+  }
+  EXPECT_TRUE(copy(1, 1).empty());
+
+  size_t sum = 0;
+  std::mutex mutex;
+  matrix_impl::shared_pool()->run(8, [&](size_t i) {
+    matrix<double> product = a(i * 32, i * 64) * a(i * 32, i * 64);
+    std::lock_guard lock(mutex);
+    sum += product.rows();
+  });
+  EXPECT_EQ(8 * 300, sum);
+}
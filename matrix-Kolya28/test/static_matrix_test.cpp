@@ -0,0 +1,115 @@
+#include "static_matrix.h"
+#include "test_helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <type_traits>
+
+namespace {
+template <class M>
+constexpr typename M::value_type col_sum(const M& m, size_t col) {
+  return std::accumulate(m.col_begin(col), m.col_end(col), typename M::value_type{});
+}
+
+constexpr static_matrix<int, 2, 3> A({
+    {1, 2, 3},
+    {4, 5, 6},
+});
+
+constexpr static_matrix<int, 3, 2> B({
+    {7, 8},
+    {9, 10},
+    {11, 12},
+});
+} // namespace
+
+TEST(static_matrix_test, layout) {
+  EXPECT_EQ(36, sizeof(static_matrix<float, 3, 3>));
+  EXPECT_EQ(64, sizeof(static_matrix<float, 4, 4>));
+  EXPECT_EQ(64, alignof(static_matrix<float, 4, 4>));
+  EXPECT_EQ(64, alignof(static_matrix<double, 4, 4>));
+  EXPECT_EQ(16, alignof(static_matrix<float, 2, 2>));
+  EXPECT_EQ(alignof(double), alignof(static_matrix<double, 3, 3>));
+
+  EXPECT_TRUE((std::is_trivially_copyable_v<static_matrix<double, 4, 4>>));
+  EXPECT_TRUE((std::is_same_v<matrix<int>::col_iterator, static_matrix<int, 3, 4>::col_iterator>));
+  EXPECT_TRUE((std::is_same_v<matrix<int>::const_row_iterator, static_matrix<int, 3, 4>::const_row_iterator>));
+}
+
+TEST(static_matrix_test, constexpr_operations) {
+  static_assert(A.rows() == 2 && A.cols() == 3 && A.size() == 6);
+  static_assert(A(1, 2) == 6);
+  static_assert(A * 2 == static_matrix<int, 2, 3>({{2, 4, 6}, {8, 10, 12}}));
+  static_assert(A + A - A == A);
+  static_assert(A * B == static_matrix<int, 2, 2>({{58, 64}, {139, 154}}));
+  static_assert(*(A.col_begin(1) + 1) == 5);
+  static_assert(A.col_end(2) - A.col_begin(2) == 2);
+  static_assert(col_sum(B, 1) == 30);
+}
+
+TEST(static_matrix_test, default_zero) {
+  static_matrix<double, 3, 3> a;
+  for (double x : a) {
+    EXPECT_EQ(0.0, x);
+  }
+}
+
+TEST(static_matrix_test, element_access) {
+  static_matrix<int, 2, 3> a;
+
+  a(0, 2) = 5;
+  a(1, 1) = 42;
+  a(1, 2) = a(0, 2);
+
+  EXPECT_EQ(0, a(0, 0));
+  EXPECT_EQ(5, a(0, 2));
+  EXPECT_EQ(42, a(1, 1));
+  EXPECT_EQ(5, a(1, 2));
+  EXPECT_EQ(42, a.data()[4]);
+}
+
+TEST(static_matrix_test, compound) {
+  static_matrix<int, 2, 2> a({
+      {1, 2},
+      {3, 4},
+  });
+
+  a *= a;
+  EXPECT_EQ((static_matrix<int, 2, 2>({{7, 10}, {15, 22}})), a);
+  a -= a * 2;
+  a += static_matrix<int, 2, 2>({{7, 10}, {15, 22}});
+  EXPECT_EQ((static_matrix<int, 2, 2>()), a);
+}
+
+TEST(static_matrix_test, mul_matches_dynamic) {
+  static_matrix<double, 4, 4> a;
+  static_matrix<double, 4, 4> b;
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      a(i, j) = static_cast<double>(elem(i, j));
+      b(i, j) = static_cast<double>(elem(j, i)) - 3.0;
+    }
+  }
+
+  expect_equal(matrix<double>(a) * matrix<double>(b), a * b);
+}
+
+TEST(static_matrix_test, mul_large) {
+  static_matrix<int, 9, 10> a;
+  static_matrix<int, 10, 11> b;
+  std::iota(a.begin(), a.end(), 0);
+  std::iota(b.begin(), b.end(), -50);
+
+  expect_equal(matrix<int>(a) * matrix<int>(b), a * b);
+}
+
+TEST(static_matrix_test, dynamic_interop) {
+  matrix<int> a = A;
+  expect_equal(matrix<int>({{1, 2, 3}, {4, 5, 6}}), a);
+  EXPECT_EQ(A, (static_matrix<int, 2, 3>(a)));
+
+  for (size_t col = 0; col < A.cols(); ++col) {
+    EXPECT_EQ(col_sum(a, col), col_sum(A, col));
+  }
+}
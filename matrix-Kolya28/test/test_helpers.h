@@ -4,12 +4,14 @@
 
 #include <gtest/gtest.h>
 
+#include <type_traits>
+
 inline size_t elem(size_t i, size_t j) {
   return i * 101 + j * 7;
 }
 
-template <class T>
-void fill(matrix<T>& a) {
+template <class T, class Allocator>
+void fill(matrix<T, Allocator>& a) {
   for (size_t i = 0; i < a.rows(); ++i) {
     for (size_t j = 0; j < a.cols(); ++j) {
       a(i, j) = elem(i, j);
@@ -27,7 +29,7 @@ void expect_empty(const matrix<T>& m) {
 }
 
 template <class T>
-void expect_equal(const matrix<T>& expected, const matrix<T>& actual) {
+void expect_equal(const matrix<T>& expected, const std::type_identity_t<matrix<T>>& actual) {
   EXPECT_EQ(expected.rows(), actual.rows());
   EXPECT_EQ(expected.cols(), actual.cols());
   EXPECT_EQ(expected.size(), actual.size());
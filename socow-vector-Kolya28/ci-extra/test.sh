@@ -20,3 +20,6 @@ if [[ $1 == "Debug" ]]; then
 else
   cmake-build-$1/tests
 fi
+
+# the build with the socow_vector counters enabled
+cmake-build-$1/stats-tests
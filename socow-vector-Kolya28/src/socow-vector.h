@@ -1,22 +1,88 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
-#include <execution>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
 
+// Define SOCOW_VECTOR_STATS to 1 to count the allocations, copies and changes of representation of each socow_vector
+// type, see socow_vector_stats. Every translation unit of a program should use the same value.
+#ifndef SOCOW_VECTOR_STATS
+#define SOCOW_VECTOR_STATS 0
+#endif
+
+#if SOCOW_VECTOR_STATS
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#if defined(__GNUC__) || defined(__clang__)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+#endif
+
 namespace socow_vector_impl {
+// Whether objects of T can be moved to another address by copying their bytes, without a call to the destructor
+// of the source.
 template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// Reference count of buffers shared by vectors used from a single thread.
+class plain_ref_count {
+public:
+  void add_ref() noexcept {
+    ++_count;
+  }
+
+  // returns whether the last reference is released
+  bool release() noexcept {
+    return --_count == 0;
+  }
+
+  size_t count() const noexcept {
+    return _count;
+  }
+
+private:
+  size_t _count = 0;
+};
+
+// Reference count of buffers shared by vectors used from different threads, like the one of std::shared_ptr.
+// Releases are ordered before the destruction of the buffer, and observing the count of one orders the accesses of
+// the former owners before the writes to the now unique buffer.
+class atomic_ref_count {
+public:
+  void add_ref() noexcept {
+    _count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  bool release() noexcept {
+    return _count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+
+  size_t count() const noexcept {
+    return _count.load(std::memory_order_acquire);
+  }
+
+private:
+  std::atomic<size_t> _count = 0;
+};
+
+template <typename T, typename RefCount>
 struct shared_buffer {
   size_t capacity;
-  size_t ref_count;
+  RefCount ref_count;
   T data[0];
 
   static shared_buffer* allocate(size_t capacity) {
     auto new_buf = static_cast<shared_buffer*>(operator new(sizeof(shared_buffer) + sizeof(T) * capacity));
-    new (new_buf) shared_buffer{capacity, 0, {}};
+    new (new_buf) shared_buffer{capacity, {}, {}};
     return new_buf;
   }
 
@@ -26,7 +92,7 @@ struct shared_buffer {
   }
 
   static void release_ref(shared_buffer* buffer, size_t size) {
-    if (--buffer->ref_count == 0) {
+    if (buffer->ref_count.release()) {
       std::destroy_n(buffer->data, size);
       deallocate(buffer);
     }
@@ -34,7 +100,81 @@ struct shared_buffer {
 };
 } // namespace socow_vector_impl
 
-template <typename T, size_t SMALL_SIZE>
+// Counters of one socow_vector type, updated only when SOCOW_VECTOR_STATS is enabled. Unshare copies are the
+// copies of a shared buffer made for a non-const access or a change, so a high count usually means non-const
+// data(), begin() or operator[] calls on vectors that are only read.
+struct socow_vector_stats {
+  std::atomic<size_t> allocations = 0;
+  std::atomic<size_t> shares = 0;
+  std::atomic<size_t> unshare_copies = 0;
+  std::atomic<size_t> small_to_large = 0;
+  std::atomic<size_t> large_to_small = 0;
+  // by copies of elements, relocations aren't counted
+  std::atomic<size_t> bytes_copied = 0;
+
+  void reset() noexcept {
+    for (std::atomic<size_t>* counter :
+         {&allocations, &shares, &unshare_copies, &small_to_large, &large_to_small, &bytes_copied}) {
+      counter->store(0, std::memory_order_relaxed);
+    }
+  }
+};
+
+#if SOCOW_VECTOR_STATS
+namespace socow_vector_impl {
+struct registered_stats : socow_vector_stats {
+  std::string type_name;
+  registered_stats* next = nullptr;
+};
+
+inline std::atomic<registered_stats*> all_stats = nullptr;
+
+template <typename Vector>
+socow_vector_stats& stats_of() {
+  static registered_stats* stats = [] {
+    auto* result = new registered_stats;
+    const char* name = typeid(Vector).name();
+#if defined(__GNUC__) || defined(__clang__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    result->type_name = (status == 0) ? demangled : name;
+    std::free(demangled);
+#else
+    result->type_name = name;
+#endif
+    result->next = all_stats.load(std::memory_order_relaxed);
+    while (!all_stats.compare_exchange_weak(result->next, result, std::memory_order_release)) {}
+    return result;
+  }();
+  return *stats;
+}
+} // namespace socow_vector_impl
+
+// one line per socow_vector type used so far
+inline void dump_socow_vector_stats(std::ostream& out) {
+  auto* stats = socow_vector_impl::all_stats.load(std::memory_order_acquire);
+  for (; stats != nullptr; stats = stats->next) {
+    out << stats->type_name << ": allocations " << stats->allocations << ", shares " << stats->shares
+        << ", unshare copies " << stats->unshare_copies << ", small to large " << stats->small_to_large
+        << ", large to small " << stats->large_to_small << ", bytes copied " << stats->bytes_copied << '\n';
+  }
+}
+
+inline void reset_socow_vector_stats() noexcept {
+  auto* stats = socow_vector_impl::all_stats.load(std::memory_order_acquire);
+  for (; stats != nullptr; stats = stats->next) {
+    stats->reset();
+  }
+}
+#endif
+
+template <typename T, size_t SMALL_SIZE, typename RefCount>
+class socow_slice;
+
+// RefCount is socow_vector_impl::plain_ref_count by default, copies of a vector sharing a buffer can then be used
+// only from one thread at a time. With socow_vector_impl::atomic_ref_count, see shared_socow_vector, different
+// copies can be used from different threads, same as with distinct vectors.
+template <typename T, size_t SMALL_SIZE, typename RefCount = socow_vector_impl::plain_ref_count>
 class socow_vector {
 public:
   using value_type = T;
@@ -49,7 +189,7 @@ public:
   using const_iterator = const_pointer;
 
 private:
-  using buffer = socow_vector_impl::shared_buffer<T>;
+  using buffer = socow_vector_impl::shared_buffer<T, RefCount>;
 
   union {
     buffer* _dynamic_buffer;
@@ -63,13 +203,25 @@ private:
     return _is_small;
   }
 
+  static void count([[maybe_unused]] std::atomic<size_t> socow_vector_stats::*counter,
+                    [[maybe_unused]] size_t n = 1) noexcept {
+#if SOCOW_VECTOR_STATS
+    (stats().*counter).fetch_add(n, std::memory_order_relaxed);
+#endif
+  }
+
+  static void count_copies(size_t n) noexcept {
+    count(&socow_vector_stats::bytes_copied, n * sizeof(T));
+  }
+
   bool is_shared() const noexcept {
-    return !is_small() && _dynamic_buffer->ref_count > 1;
+    return !is_small() && _dynamic_buffer->ref_count.count() > 1;
   }
 
   explicit socow_vector(size_t initial_capacity) : _size(0), _is_small(true) {
     if (initial_capacity > SMALL_SIZE) {
       assign_buffer(buffer::allocate(initial_capacity));
+      count(&socow_vector_stats::allocations);
     }
   }
 
@@ -77,6 +229,7 @@ private:
     socow_vector temp(new_capacity);
     std::uninitialized_copy_n(other.data(), other.size(), temp.unsafe_data());
     temp._size = other.size();
+    count_copies(other.size());
     swap(temp);
   }
 
@@ -86,7 +239,7 @@ private:
     _size = s;
     _dynamic_buffer = new_buffer;
     _is_small = false;
-    ++_dynamic_buffer->ref_count;
+    _dynamic_buffer->ref_count.add_ref();
   }
 
   void clear_and_make_small() noexcept {
@@ -105,6 +258,7 @@ private:
       return;
     }
 
+    count(&socow_vector_stats::unshare_copies);
     set_capacity(_dynamic_buffer->capacity);
   }
 
@@ -119,6 +273,8 @@ private:
     }
     buffer::release_ref(temp, size());
     _is_small = true;
+    count(&socow_vector_stats::large_to_small);
+    count_copies(other.size());
   }
 
   pointer unsafe_data() {
@@ -129,18 +285,115 @@ private:
     return is_small() ? _small_data : _dynamic_buffer->data;
   }
 
+  // Constructs count elements at out from the ones at first, moving them if that can't throw and copying
+  // otherwise, so on exception the source is unchanged. The source elements are left to destroy_relocated().
+  static void uninitialized_relocate(pointer first, size_t count, pointer out) {
+    if constexpr (socow_vector_impl::is_trivially_relocatable<T>::value) {
+      if (count != 0) {
+        std::memcpy(static_cast<void*>(out), static_cast<const void*>(first), sizeof(T) * count);
+      }
+    } else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+      std::uninitialized_copy_n(std::make_move_iterator(first), count, out);
+    } else {
+      std::uninitialized_copy_n(first, count, out);
+    }
+  }
+
+  static void destroy_relocated(pointer first, size_t count) noexcept {
+    if constexpr (!socow_vector_impl::is_trivially_relocatable<T>::value) {
+      std::destroy_n(first, count);
+    }
+  }
+
+  static constexpr bool nothrow_relocatable =
+      socow_vector_impl::is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible_v<T>;
+
+  // Takes the buffer of a large other or relocates the elements of a small one, other is left empty and small.
+  // This vector should be empty and small.
+  void take(socow_vector& other) noexcept(nothrow_relocatable) {
+    assert(is_small() && empty());
+    if (other.is_small()) {
+      uninitialized_relocate(other._small_data, other.size(), _small_data);
+      destroy_relocated(other._small_data, other.size());
+    } else {
+      _dynamic_buffer = other._dynamic_buffer;
+      _is_small = false;
+      other._is_small = true;
+    }
+    _size = other.size();
+    other._size = 0;
+  }
+
+  // Appends to a new buffer, either because this one is full or because it's shared. The new element is
+  // constructed first, since the arguments may refer to the elements. Elements owned only by this vector are
+  // relocated and the ones of a shared buffer are copied.
+  template <typename... Args>
+  void emplace_back_reallocating(Args&&... args) {
+    bool shared = is_shared();
+    size_t new_capacity = (size() == capacity()) ? std::max(capacity() * 2, size() + 1) : capacity();
+    buffer* new_buffer = buffer::allocate(new_capacity);
+    try {
+      new (new_buffer->data + size()) T(std::forward<Args>(args)...);
+      try {
+        if (shared) {
+          std::uninitialized_copy_n(unsafe_data(), size(), new_buffer->data);
+        } else {
+          uninitialized_relocate(unsafe_data(), size(), new_buffer->data);
+        }
+      } catch (...) {
+        new_buffer->data[size()].~T();
+        throw;
+      }
+    } catch (...) {
+      buffer::deallocate(new_buffer);
+      throw;
+    }
+
+    if (shared) {
+      buffer::release_ref(_dynamic_buffer, size());
+    } else {
+      destroy_relocated(unsafe_data(), size());
+      if (!is_small()) {
+        buffer::deallocate(_dynamic_buffer);
+      }
+    }
+    if (shared) {
+      count(&socow_vector_stats::unshare_copies);
+      count_copies(size());
+    }
+    if (is_small()) {
+      count(&socow_vector_stats::small_to_large);
+    }
+    count(&socow_vector_stats::allocations);
+    _dynamic_buffer = new_buffer;
+    _dynamic_buffer->ref_count.add_ref();
+    _is_small = false;
+    ++_size;
+  }
+
 public:
   socow_vector() noexcept : _size(0), _is_small(true) {}
 
+#if SOCOW_VECTOR_STATS
+  static socow_vector_stats& stats() {
+    return socow_vector_impl::stats_of<socow_vector>();
+  }
+#endif
+
   socow_vector(const socow_vector& other) : _size(0), _is_small(true) {
     if (!other.is_small()) {
       assign_buffer(other._dynamic_buffer);
       _size = other.size();
+      count(&socow_vector_stats::shares);
     } else {
       copy_and_swap(other, other.size());
     }
   }
 
+  socow_vector(socow_vector&& other) noexcept(nothrow_relocatable) : _size(0), _is_small(true) {
+    take(other);
+  }
+
   ~socow_vector() noexcept {
     clear_and_make_small();
   }
@@ -152,6 +405,7 @@ public:
 
     if (!other.is_small()) {
       assign_buffer(other._dynamic_buffer);
+      count(&socow_vector_stats::shares);
 
     } else if (!is_small() && other.is_small()) {
       big_to_small(other);
@@ -169,6 +423,7 @@ public:
         std::destroy(_small_data + other.size(), _small_data + size());
       }
       _size = other.size();
+      count_copies(other.size());
       std::swap_ranges(temp._small_data, temp._small_data + temp.size(), _small_data);
     }
 
@@ -176,6 +431,15 @@ public:
     return *this;
   }
 
+  // if relocating the elements of a small other throws, this vector is left empty
+  socow_vector& operator=(socow_vector&& other) noexcept(nothrow_relocatable) {
+    if (&other != this) {
+      clear_and_make_small();
+      take(other);
+    }
+    return *this;
+  }
+
   reference operator[](size_t index) noexcept {
     assert(index < size() && "Out of range in subscript operator");
     return data()[index];
@@ -220,7 +484,22 @@ public:
   }
 
   void push_back(const T& value) {
-    insert(cend(), value);
+    emplace_back(value);
+  }
+
+  void push_back(T&& value) {
+    emplace_back(std::move(value));
+  }
+
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    if (size() == capacity() || is_shared()) {
+      emplace_back_reallocating(std::forward<Args>(args)...);
+    } else {
+      new (unsafe_data() + size()) T(std::forward<Args>(args)...);
+      ++_size;
+    }
+    return unsafe_data()[size() - 1];
   }
 
   void pop_back() {
@@ -247,7 +526,11 @@ public:
       socow_vector temp(new_capacity);
       std::uninitialized_copy_n(unsafe_data(), size(), temp.unsafe_data());
       temp._size = size();
-      *this = temp;
+      if (is_small()) {
+        count(&socow_vector_stats::small_to_large);
+      }
+      count_copies(size());
+      *this = std::move(temp);
     }
   }
 
@@ -289,13 +572,23 @@ public:
 
       std::uninitialized_copy_n(copy_from + min_size, max_size - min_size, copy_to + min_size);
       std::destroy_n(copy_from + min_size, max_size - min_size);
+      count_copies(max_size - min_size);
 
       std::swap(_size, other._size);
       std::swap_ranges(_small_data, _small_data + min_size, other._small_data);
     } else if (!is_small() && other.is_small()) {
-      socow_vector temp = *this;
-      *this = other;
-      other = temp;
+      // the elements of other move into the place of the buffer pointer
+      buffer* temp = _dynamic_buffer;
+      try {
+        uninitialized_relocate(other._small_data, other.size(), _small_data);
+      } catch (...) {
+        _dynamic_buffer = temp;
+        throw;
+      }
+      destroy_relocated(other._small_data, other.size());
+      other._dynamic_buffer = temp;
+      std::swap(_size, other._size);
+      std::swap(_is_small, other._is_small);
     } else if (is_small() && !other.is_small()) {
       other.swap(*this);
     } else {
@@ -304,6 +597,10 @@ public:
     }
   }
 
+  friend void swap(socow_vector& left, socow_vector& right) {
+    left.swap(right);
+  }
+
   iterator begin() {
     return data();
   }
@@ -328,10 +625,20 @@ public:
     return std::as_const(*this).end();
   }
 
+  // elements [offset, offset + length), sharing the buffer of a large vector
+  socow_slice<T, SMALL_SIZE, RefCount> slice(size_t offset, size_t length) const {
+    return {*this, offset, length};
+  }
+
   iterator insert(const_iterator pos, const T& value) {
     size_t index = pos - cbegin();
     assert(index <= size() && "Index out of range in vector::insert()");
 
+    if (index == size()) {
+      emplace_back(value);
+      return unsafe_data() + index;
+    }
+
     size_t cap = capacity();
 
     if (size() + 1 > cap || is_shared()) {
@@ -342,7 +649,14 @@ public:
       ++temp._size;
       std::uninitialized_copy(unsafe_data() + index, unsafe_data() + size(), temp.unsafe_data() + temp.size());
       temp._size = size() + 1;
-      *this = temp;
+      if (is_shared()) {
+        count(&socow_vector_stats::unshare_copies);
+      }
+      if (is_small()) {
+        count(&socow_vector_stats::small_to_large);
+      }
+      count_copies(size() + 1);
+      *this = std::move(temp);
       return unsafe_data() + index;
     }
 
@@ -380,7 +694,9 @@ public:
       std::uninitialized_copy_n(_dynamic_buffer->data + last_index, new_size - index, temp.unsafe_data() + index);
       temp._size = new_size;
 
-      *this = temp;
+      count(&socow_vector_stats::unshare_copies);
+      count_copies(new_size);
+      *this = std::move(temp);
       return unsafe_data() + index;
     }
 
@@ -391,3 +707,152 @@ public:
     return unsafe_data() + index;
   }
 };
+
+// Range of elements of a socow_vector. A slice keeps a copy of the vector, so slices of large vectors share their
+// buffer and stay valid after the vector is changed or destroyed. Reads are zero-copy, the first non-const access
+// copies only the elements of the slice, unless it's the last owner of the whole buffer.
+template <typename T, size_t SMALL_SIZE, typename RefCount>
+class socow_slice {
+public:
+  using vector_type = socow_vector<T, SMALL_SIZE, RefCount>;
+
+  using value_type = T;
+
+  using reference = T&;
+  using const_reference = const T&;
+
+  using pointer = T*;
+  using const_pointer = const T*;
+
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+private:
+  vector_type _source;
+  size_t _offset = 0;
+  size_t _size = 0;
+
+  // makes the slice cover the whole source, so that it can be changed in place the same way as a vector
+  void detach() {
+    if (_offset == 0 && _size == _source.size()) {
+      return;
+    }
+    vector_type copy;
+    copy.reserve(_size);
+    for (const_reference value : std::as_const(*this)) {
+      copy.push_back(value);
+    }
+    _source = std::move(copy);
+    _offset = 0;
+  }
+
+public:
+  socow_slice() = default;
+
+  socow_slice(const vector_type& source, size_t offset, size_t length)
+      : _source(source),
+        _offset(offset),
+        _size(length) {
+    assert(offset <= source.size() && length <= source.size() - offset && "Slice out of range");
+  }
+
+  size_t size() const noexcept {
+    return _size;
+  }
+
+  bool empty() const noexcept {
+    return size() == 0;
+  }
+
+  reference operator[](size_t index) {
+    assert(index < size() && "Out of range in subscript operator");
+    return data()[index];
+  }
+
+  const_reference operator[](size_t index) const noexcept {
+    assert(index < size() && "Out of range in subscript operator");
+    return data()[index];
+  }
+
+  pointer data() {
+    detach();
+    return _source.data();
+  }
+
+  const_pointer data() const noexcept {
+    return _source.data() + _offset;
+  }
+
+  reference front() {
+    assert(!empty() && "Getting front element from empty slice");
+    return *begin();
+  }
+
+  const_reference front() const noexcept {
+    assert(!empty() && "Getting front element from empty slice");
+    return *begin();
+  }
+
+  reference back() {
+    assert(!empty() && "Getting back element from empty slice");
+    return *(end() - 1);
+  }
+
+  const_reference back() const noexcept {
+    assert(!empty() && "Getting back element from empty slice");
+    return *(end() - 1);
+  }
+
+  iterator begin() {
+    return data();
+  }
+
+  iterator end() {
+    return begin() + size();
+  }
+
+  const_iterator begin() const noexcept {
+    return data();
+  }
+
+  const_iterator end() const noexcept {
+    return begin() + size();
+  }
+
+  const_iterator cbegin() const noexcept {
+    return std::as_const(*this).begin();
+  }
+
+  const_iterator cend() const noexcept {
+    return std::as_const(*this).end();
+  }
+
+  socow_slice slice(size_t offset, size_t length) const {
+    assert(offset <= size() && length <= size() - offset && "Slice out of range");
+    socow_slice result = *this;
+    result._offset += offset;
+    result._size = length;
+    return result;
+  }
+
+  // shares the buffer if the slice covers the whole vector, otherwise copies the elements of the slice
+  vector_type to_vector() const& {
+    socow_slice copy = *this;
+    copy.detach();
+    return std::move(copy._source);
+  }
+
+  vector_type to_vector() && {
+    detach();
+    return std::move(_source);
+  }
+};
+
+namespace socow_vector_impl {
+// the elements of a large vector are in a separate buffer and the ones of a small vector are relocated together with it
+template <typename T, size_t SMALL_SIZE, typename RefCount>
+struct is_trivially_relocatable<socow_vector<T, SMALL_SIZE, RefCount>> : is_trivially_relocatable<T> {};
+} // namespace socow_vector_impl
+
+template <typename T, size_t SMALL_SIZE>
+using shared_socow_vector = socow_vector<T, SMALL_SIZE, socow_vector_impl::atomic_ref_count>;
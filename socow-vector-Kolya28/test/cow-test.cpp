@@ -909,3 +909,45 @@ TEST_F(cow_test, unshare_throw) {
   element::set_copy_throw_countdown(3);
   EXPECT_THROW(a.data(), std::runtime_error);
 }
+
+TEST_F(cow_test, move_ctor) {
+  container a;
+  for (size_t i = 0; i < 5; ++i) {
+    a.push_back(i + 100);
+  }
+  container b = a;
+  const element* data = as_const(a).data();
+
+  element::reset_counters();
+  container c = std::move(a);
+  EXPECT_EQ(data, as_const(c).data());
+  EXPECT_EQ(data, as_const(b).data());
+  expect_empty_storage(a);
+  EXPECT_EQ(0, element::get_copy_counter());
+}
+
+TEST_F(cow_test, move_assignment) {
+  container a;
+  for (size_t i = 0; i < 5; ++i) {
+    a.push_back(i + 100);
+  }
+  const element* data = as_const(a).data();
+
+  container b;
+  b.push_back(1);
+  container c;
+  for (size_t i = 0; i < 10; ++i) {
+    c.push_back(i + 200);
+  }
+  container d = c;
+
+  element::reset_counters();
+  b = std::move(a);
+  c = std::move(b);
+  EXPECT_EQ(data, as_const(c).data());
+  EXPECT_EQ(0, element::get_copy_counter());
+  expect_empty_storage(a);
+  expect_empty_storage(b);
+  EXPECT_EQ(10, d.size());
+  EXPECT_EQ(209, as_const(d).back());
+}
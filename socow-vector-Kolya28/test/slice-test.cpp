@@ -0,0 +1,164 @@
+#include "socow-vector.h"
+#include "test-utils.h"
+
+#include <gtest/gtest.h>
+
+using std::as_const;
+
+template class socow_slice<element, 3, socow_vector_impl::plain_ref_count>;
+using slice = socow_slice<element, 3, socow_vector_impl::plain_ref_count>;
+
+class slice_test : public base_test {};
+
+namespace {
+
+container make_vector(size_t size) {
+  container a;
+  for (size_t i = 0; i < size; ++i) {
+    a.push_back(i + 100);
+  }
+  return a;
+}
+
+} // namespace
+
+TEST_F(slice_test, shares_buffer) {
+  container a = make_vector(10);
+
+  element::reset_counters();
+  slice s = a.slice(2, 5);
+  EXPECT_EQ(0, element::get_copy_counter());
+
+  ASSERT_EQ(5, s.size());
+  EXPECT_EQ(as_const(a).data() + 2, as_const(s).data());
+  for (size_t i = 0; i < s.size(); ++i) {
+    EXPECT_EQ(i + 102, as_const(s)[i]);
+  }
+  EXPECT_EQ(102, as_const(s).front());
+  EXPECT_EQ(106, as_const(s).back());
+  EXPECT_EQ(as_const(s).begin() + 5, as_const(s).end());
+}
+
+TEST_F(slice_test, empty) {
+  container a = make_vector(10);
+  slice s = a.slice(10, 0);
+  EXPECT_TRUE(s.empty());
+  EXPECT_EQ(s.cbegin(), s.cend());
+
+  slice d;
+  EXPECT_TRUE(d.empty());
+}
+
+TEST_F(slice_test, outlives_source) {
+  slice s;
+  {
+    container a = make_vector(10);
+    s = a.slice(3, 4);
+  }
+  ASSERT_EQ(4, s.size());
+  for (size_t i = 0; i < s.size(); ++i) {
+    EXPECT_EQ(i + 103, as_const(s)[i]);
+  }
+}
+
+TEST_F(slice_test, source_change_not_visible) {
+  container a = make_vector(10);
+  slice s = a.slice(3, 4);
+  a[3] = 42;
+  a.clear();
+  ASSERT_EQ(4, s.size());
+  EXPECT_EQ(103, as_const(s)[0]);
+}
+
+TEST_F(slice_test, mutation_copies_range) {
+  container a = make_vector(10);
+  slice s = a.slice(2, 5);
+  immutable_guard guard(a);
+
+  element::reset_counters();
+  s.data();
+  EXPECT_EQ(5, element::get_copy_counter());
+  s[1] = 42;
+
+  EXPECT_NE(as_const(a).data() + 2, as_const(s).data());
+  ASSERT_EQ(5, s.size());
+  EXPECT_EQ(102, as_const(s)[0]);
+  EXPECT_EQ(42, as_const(s)[1]);
+  EXPECT_EQ(106, as_const(s)[4]);
+}
+
+TEST_F(slice_test, mutation_unique_whole) {
+  slice s = make_vector(10).slice(0, 10);
+  const element* data = as_const(s).data();
+
+  element::reset_counters();
+  s.data();
+  EXPECT_EQ(0, element::get_copy_counter());
+  s.front() = 42;
+  s.back() = 43;
+  EXPECT_EQ(data, as_const(s).data());
+  EXPECT_EQ(42, as_const(s)[0]);
+  EXPECT_EQ(43, as_const(s)[9]);
+}
+
+TEST_F(slice_test, mutation_shared_whole) {
+  container a = make_vector(10);
+  slice s = a.slice(0, 10);
+  immutable_guard guard(a);
+
+  *s.begin() = 42;
+  EXPECT_EQ(42, as_const(s)[0]);
+}
+
+TEST_F(slice_test, small_source) {
+  container a = make_vector(3);
+  slice s = a.slice(1, 2);
+  expect_static_storage(a);
+
+  ASSERT_EQ(2, s.size());
+  EXPECT_EQ(101, as_const(s)[0]);
+  EXPECT_EQ(102, as_const(s)[1]);
+
+  s[0] = 42;
+  EXPECT_EQ(101, as_const(a)[1]);
+  EXPECT_EQ(42, as_const(s)[0]);
+}
+
+TEST_F(slice_test, slice_of_slice) {
+  container a = make_vector(10);
+  slice s = a.slice(2, 6);
+
+  element::reset_counters();
+  slice t = s.slice(1, 3);
+  EXPECT_EQ(0, element::get_copy_counter());
+
+  EXPECT_EQ(as_const(a).data() + 3, as_const(t).data());
+  ASSERT_EQ(3, t.size());
+  for (size_t i = 0; i < t.size(); ++i) {
+    EXPECT_EQ(i + 103, as_const(t)[i]);
+  }
+}
+
+TEST_F(slice_test, to_vector_whole) {
+  container a = make_vector(10);
+
+  element::reset_counters();
+  container b = a.slice(0, 10).to_vector();
+  EXPECT_EQ(0, element::get_copy_counter());
+  EXPECT_EQ(as_const(a).data(), as_const(b).data());
+}
+
+TEST_F(slice_test, to_vector_part) {
+  container a = make_vector(10);
+  slice s = a.slice(4, 5);
+
+  element::reset_counters();
+  container b = s.to_vector();
+  EXPECT_EQ(5, element::get_copy_counter());
+
+  ASSERT_EQ(5, b.size());
+  for (size_t i = 0; i < b.size(); ++i) {
+    EXPECT_EQ(i + 104, as_const(b)[i]);
+  }
+  EXPECT_EQ(as_const(a).data() + 4, as_const(s).data());
+}
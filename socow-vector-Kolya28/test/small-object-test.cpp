@@ -3,6 +3,8 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+
 using std::as_const;
 
 class small_object_test : public base_test {};
@@ -1221,3 +1223,75 @@ TEST_F(small_object_test, insert_small_into_big_copies) {
   EXPECT_EQ(4, element::get_copy_counter());
   EXPECT_EQ(0, element::get_swap_counter());
 }
+
+TEST_F(small_object_test, move_ctor_small) {
+  container a;
+  a.push_back(1);
+  a.push_back(2);
+
+  element::reset_counters();
+  container b = std::move(a);
+  EXPECT_GE(2, element::get_copy_counter());
+  expect_empty_storage(a);
+  expect_static_storage(b);
+  ASSERT_EQ(2, b.size());
+  EXPECT_EQ(1, b[0]);
+  EXPECT_EQ(2, b[1]);
+}
+
+TEST_F(small_object_test, move_ctor_small_throw) {
+  container a;
+  a.push_back(1);
+  a.push_back(2);
+
+  immutable_guard g(a);
+  element::set_copy_throw_countdown(2);
+  EXPECT_THROW(container b = std::move(a), std::runtime_error);
+}
+
+TEST_F(small_object_test, move_assignment_small_to_big) {
+  container a;
+  a.push_back(1);
+
+  container b;
+  for (size_t i = 0; i < 10; ++i) {
+    b.push_back(i + 100);
+  }
+
+  b = std::move(a);
+  expect_empty_storage(a);
+  expect_static_storage(b);
+  ASSERT_EQ(1, b.size());
+  EXPECT_EQ(1, b[0]);
+}
+
+TEST_F(small_object_test, move_assignment_self) {
+  container a;
+  a.push_back(1);
+  a.push_back(2);
+
+  immutable_guard g(a);
+  container& ref = a;
+  a = std::move(ref);
+}
+
+TEST_F(small_object_test, swap_big_and_small_relocates) {
+  socow_vector<std::string, 3> a;
+  for (size_t i = 0; i < 10; ++i) {
+    a.push_back(std::to_string(i));
+  }
+  socow_vector<std::string, 3> b;
+  b.push_back(std::string(100, 'x'));
+  const char* chars = as_const(b)[0].data();
+  const std::string* data = as_const(a).data();
+
+  a.swap(b);
+  ASSERT_EQ(1, a.size());
+  EXPECT_EQ(chars, as_const(a)[0].data());
+  EXPECT_EQ(data, as_const(b).data());
+  EXPECT_EQ(3, a.capacity());
+
+  swap(a, b);
+  EXPECT_EQ(data, as_const(a).data());
+  EXPECT_EQ(chars, as_const(b)[0].data());
+}
@@ -0,0 +1,94 @@
+#include "socow-vector.h"
+#include "test-utils.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+using std::as_const;
+
+class stats_test : public base_test {
+protected:
+  void SetUp() override {
+    base_test::SetUp();
+    reset_socow_vector_stats();
+  }
+};
+
+TEST_F(stats_test, small_to_large) {
+  container a;
+  for (size_t i = 0; i < 4; ++i) {
+    a.push_back(i + 100);
+  }
+
+  socow_vector_stats& stats = container::stats();
+  EXPECT_EQ(1, stats.allocations);
+  EXPECT_EQ(1, stats.small_to_large);
+  EXPECT_EQ(0, stats.large_to_small);
+  EXPECT_EQ(0, stats.unshare_copies);
+  EXPECT_EQ(0, stats.bytes_copied);
+
+  a.pop_back();
+  a.shrink_to_fit();
+  EXPECT_EQ(1, stats.large_to_small);
+  EXPECT_EQ(3 * sizeof(element), stats.bytes_copied);
+}
+
+TEST_F(stats_test, share_and_unshare) {
+  container a;
+  a.reserve(5);
+  for (size_t i = 0; i < 5; ++i) {
+    a.push_back(i + 100);
+  }
+
+  socow_vector_stats& stats = container::stats();
+  stats.reset();
+
+  container b = a;
+  container c;
+  c = a;
+  EXPECT_EQ(2, stats.shares);
+  EXPECT_EQ(0, stats.allocations);
+
+  for (size_t i = 0; i < c.size(); ++i) {
+    EXPECT_EQ(i + 100, as_const(c)[i]);
+  }
+  EXPECT_EQ(0, stats.unshare_copies);
+
+  b[0] = 42;
+  EXPECT_EQ(1, stats.unshare_copies);
+  EXPECT_EQ(1, stats.allocations);
+  EXPECT_EQ(5 * sizeof(element), stats.bytes_copied);
+
+  b[1] = 43;
+  EXPECT_EQ(1, stats.unshare_copies);
+
+  c.push_back(44);
+  EXPECT_EQ(2, stats.unshare_copies);
+  EXPECT_EQ(10 * sizeof(element), stats.bytes_copied);
+}
+
+TEST_F(stats_test, per_type) {
+  socow_vector<int, 3> a;
+  for (int i = 0; i < 10; ++i) {
+    a.push_back(i);
+  }
+  socow_vector<int, 3> b = a;
+  b.erase(b.cbegin());
+
+  EXPECT_EQ(0, container::stats().allocations);
+  EXPECT_EQ(1, (socow_vector<int, 3>::stats().shares));
+  EXPECT_EQ(1, (socow_vector<int, 3>::stats().unshare_copies));
+  EXPECT_EQ(9 * sizeof(int), (socow_vector<int, 3>::stats().bytes_copied));
+}
+
+TEST_F(stats_test, dump) {
+  socow_vector<int, 3> a;
+  for (int i = 0; i < 4; ++i) {
+    a.push_back(i);
+  }
+  std::ostringstream out;
+  dump_socow_vector_stats(out);
+  EXPECT_NE(std::string::npos, out.str().find("socow_vector<int, 3"));
+  EXPECT_NE(std::string::npos, out.str().find("allocations 1, shares 0, unshare copies 0, small to large 1"));
+}
@@ -0,0 +1,93 @@
+#include "socow-vector.h"
+#include "test-utils.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using std::as_const;
+
+template class socow_vector<int, 3, socow_vector_impl::atomic_ref_count>;
+
+class thread_safety_test : public base_test {};
+
+namespace {
+
+constexpr size_t THREADS = 8;
+
+template <typename F>
+void run_threads(const F& f) {
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < THREADS; ++i) {
+    threads.emplace_back(f, i);
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+} // namespace
+
+TEST_F(thread_safety_test, shared_reads) {
+  constexpr size_t N = 100'000;
+  shared_socow_vector<int, 3> a;
+  for (size_t i = 0; i < N; ++i) {
+    a.push_back(static_cast<int>(i % 100));
+  }
+  long long expected = std::accumulate(as_const(a).begin(), as_const(a).end(), 0LL);
+
+  std::vector<long long> sums(THREADS);
+  run_threads([&](size_t index) {
+    for (size_t i = 0; i < 20; ++i) {
+      shared_socow_vector<int, 3> copy = a;
+      EXPECT_EQ(as_const(a).data(), as_const(copy).data());
+      sums[index] = std::accumulate(as_const(copy).begin(), as_const(copy).end(), 0LL);
+    }
+  });
+  for (long long sum : sums) {
+    EXPECT_EQ(expected, sum);
+  }
+}
+
+TEST_F(thread_safety_test, concurrent_unshare) {
+  constexpr size_t N = 10'000;
+  shared_socow_vector<int, 3> a;
+  for (size_t i = 0; i < N; ++i) {
+    a.push_back(static_cast<int>(i));
+  }
+
+  std::vector<shared_socow_vector<int, 3>> copies(THREADS, a);
+  a = shared_socow_vector<int, 3>();
+  run_threads([&](size_t index) {
+    shared_socow_vector<int, 3>& copy = copies[index];
+    for (size_t i = 0; i < N; ++i) {
+      copy[i] += static_cast<int>(index);
+    }
+    copy.push_back(-1);
+  });
+
+  for (size_t index = 0; index < THREADS; ++index) {
+    ASSERT_EQ(N + 1, copies[index].size());
+    for (size_t i = 0; i < N; ++i) {
+      ASSERT_EQ(static_cast<int>(i + index), as_const(copies[index])[i]);
+    }
+  }
+}
+
+TEST_F(thread_safety_test, last_owner) {
+  for (size_t iteration = 0; iteration < 100; ++iteration) {
+    shared_socow_vector<size_t, 3> a;
+    for (size_t i = 0; i < 10; ++i) {
+      a.push_back(i);
+    }
+    std::vector<shared_socow_vector<size_t, 3>> copies(THREADS, a);
+    a = shared_socow_vector<size_t, 3>();
+    // each thread drops its reference, the last one destroys the buffer
+    run_threads([&](size_t index) {
+      EXPECT_EQ(index, as_const(copies[index])[index]);
+      copies[index] = shared_socow_vector<size_t, 3>();
+    });
+  }
+}
@@ -3,6 +3,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
 using std::as_const;
 
 class vector_test : public base_test {};
@@ -116,6 +121,73 @@ TEST_F(vector_test, push_back_reallocation_throw_last) {
   EXPECT_THROW(a.push_back(42), std::runtime_error);
 }
 
+TEST_F(vector_test, push_back_rvalue) {
+  constexpr size_t N = 500;
+
+  socow_vector<std::string, 3> a;
+  for (size_t i = 0; i < N; ++i) {
+    std::string value(100, static_cast<char>('a' + i % 26));
+    const char* chars = value.data();
+    a.push_back(std::move(value));
+    ASSERT_EQ(chars, as_const(a).back().data());
+  }
+  for (size_t i = 0; i < N; ++i) {
+    ASSERT_EQ(std::string(100, static_cast<char>('a' + i % 26)), as_const(a)[i]);
+  }
+}
+
+TEST_F(vector_test, push_back_reallocation_relocates) {
+  constexpr size_t N = 500;
+
+  socow_vector<std::string, 3> a;
+  a.push_back(std::string(100, 'x'));
+  const char* chars = as_const(a)[0].data();
+  for (size_t i = 1; i < N; ++i) {
+    a.push_back(as_const(a)[0]);
+  }
+  EXPECT_EQ(chars, as_const(a)[0].data());
+  EXPECT_EQ(as_const(a)[0], as_const(a)[N - 1]);
+}
+
+TEST_F(vector_test, push_back_nested) {
+  constexpr size_t N = 1000;
+
+  socow_vector<socow_vector<int, 3>, 3> a;
+  a.push_back(socow_vector<int, 3>());
+  for (int i = 0; i < 10; ++i) {
+    a.back().push_back(i);
+  }
+  const int* data = as_const(a)[0].data();
+  for (size_t i = 1; i < N; ++i) {
+    a.emplace_back().push_back(static_cast<int>(i));
+  }
+
+  // the inner buffer is neither copied nor shared
+  EXPECT_EQ(data, as_const(a)[0].data());
+  EXPECT_EQ(data, a[0].data());
+  for (size_t i = 1; i < N; ++i) {
+    ASSERT_EQ(static_cast<int>(i), as_const(a)[i][0]);
+  }
+}
+
+TEST_F(vector_test, emplace_back) {
+  socow_vector<std::pair<std::string, size_t>, 3> a;
+  for (size_t i = 0; i < 100; ++i) {
+    auto& p = a.emplace_back(std::to_string(i), i);
+    EXPECT_EQ(&as_const(a).back(), &p);
+  }
+  for (size_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(std::to_string(i), as_const(a)[i].first);
+    EXPECT_EQ(i, as_const(a)[i].second);
+  }
+
+  socow_vector<std::pair<std::string, size_t>, 3> b = a;
+  b.emplace_back("shared", 0);
+  EXPECT_EQ(100, a.size());
+  EXPECT_EQ(101, b.size());
+  EXPECT_EQ("shared", as_const(b).back().first);
+}
+
 TEST_F(vector_test, subscript) {
   constexpr size_t N = 500, K = 100;
 
@@ -957,3 +1029,24 @@ TEST_F(vector_test, member_aliases) {
   EXPECT_TRUE((std::is_same<element*, container::iterator>::value));
   EXPECT_TRUE((std::is_same<const element*, container::const_iterator>::value));
 }
+
+TEST_F(vector_test, sort_vectors) {
+  constexpr size_t N = 1000;
+
+  std::vector<socow_vector<int, 3>> a(N);
+  for (size_t i = 0; i < N; ++i) {
+    int key = static_cast<int>((i * 7919) % N);
+    for (size_t j = 0; j <= i % 6; ++j) {
+      a[i].push_back(key);
+    }
+  }
+  auto less = [](const socow_vector<int, 3>& l, const socow_vector<int, 3>& r) {
+    return as_const(l)[0] < as_const(r)[0];
+  };
+  std::sort(a.begin(), a.end(), less);
+
+  for (size_t i = 0; i < N; ++i) {
+    ASSERT_EQ(static_cast<int>(i), as_const(a[i])[0]);
+    ASSERT_EQ(as_const(a[i])[0], as_const(a[i]).back());
+  }
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+
+// Monotonic memory arena. Allocations bump a pointer through blocks of geometrically growing size, deallocation
+// only gives back the most recent allocation and everything is released at once by release() or the destructor.
+// Meant for short-lived containers, such as the ones built while handling a single request. Not thread-safe.
+class arena {
+private:
+  // header of a block allocated by the arena, its storage follows it
+  struct block {
+    block* prev;
+  };
+
+  block* blocks_ = nullptr;
+  std::byte* buffer_ = nullptr;
+  size_t buffer_size_ = 0;
+  std::byte* current_ = nullptr;
+  std::byte* end_ = nullptr;
+  size_t initial_block_size_;
+  size_t next_block_size_;
+
+  static std::uintptr_t align_up(std::uintptr_t address, size_t alignment) noexcept {
+    return (address + alignment - 1) & ~std::uintptr_t(alignment - 1);
+  }
+
+  void add_block(size_t min_size) {
+    size_t size = std::max(next_block_size_, min_size);
+    if (size > std::numeric_limits<size_t>::max() - sizeof(block)) {
+      throw std::bad_alloc();
+    }
+    blocks_ = new (operator new(sizeof(block) + size)) block{blocks_};
+    current_ = reinterpret_cast<std::byte*>(blocks_ + 1);
+    end_ = current_ + size;
+    next_block_size_ = std::max(next_block_size_, size / 2) * 2;
+  }
+
+public:
+  explicit arena(size_t initial_block_size = 4096) noexcept
+      : initial_block_size_(std::max<size_t>(initial_block_size, 1)),
+        next_block_size_(initial_block_size_) {}
+
+  // the first allocations are served from buffer, which should outlive the arena
+  arena(void* buffer, size_t size, size_t initial_block_size = 4096) noexcept : arena(initial_block_size) {
+    buffer_ = static_cast<std::byte*>(buffer);
+    buffer_size_ = size;
+    current_ = buffer_;
+    end_ = buffer_ + size;
+  }
+
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  ~arena() noexcept {
+    release();
+  }
+
+  void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+    assert((alignment & (alignment - 1)) == 0 && "Alignment should be a power of two");
+    auto end = reinterpret_cast<std::uintptr_t>(end_);
+    std::uintptr_t first = align_up(reinterpret_cast<std::uintptr_t>(current_), alignment);
+    if (current_ == nullptr || first > end || end - first < bytes) {
+      if (bytes > std::numeric_limits<size_t>::max() - alignment) {
+        throw std::bad_alloc();
+      }
+      add_block(bytes + alignment - 1);
+      first = align_up(reinterpret_cast<std::uintptr_t>(current_), alignment);
+    }
+    current_ = reinterpret_cast<std::byte*>(first + bytes);
+    return reinterpret_cast<void*>(first);
+  }
+
+  // only the most recent allocation is reused, other storage is kept until release()
+  void deallocate(void* p, size_t bytes) noexcept {
+    if (static_cast<std::byte*>(p) + bytes == current_) {
+      current_ = static_cast<std::byte*>(p);
+    }
+  }
+
+  // frees all the blocks at once, the storage of every allocation becomes invalid
+  void release() noexcept {
+    while (blocks_ != nullptr) {
+      block* prev = blocks_->prev;
+      operator delete(blocks_);
+      blocks_ = prev;
+    }
+    current_ = buffer_;
+    end_ = buffer_ + buffer_size_;
+    next_block_size_ = initial_block_size_;
+  }
+};
+
+// Allocator drawing the storage from an arena, which should outlive the containers using it. Like
+// std::pmr::polymorphic_allocator, it stays with a container on copy, move and swap, so containers of different
+// arenas copy their elements instead of exchanging storage.
+template <typename T>
+class arena_allocator {
+public:
+  using value_type = T;
+
+  arena_allocator(arena& a) noexcept : arena_(&a) {}
+
+  template <typename U>
+  arena_allocator(const arena_allocator<U>& other) noexcept : arena_(other.get_arena()) {}
+
+  T* allocate(size_t n) {
+    if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    arena_->deallocate(p, n * sizeof(T));
+  }
+
+  arena* get_arena() const noexcept {
+    return arena_;
+  }
+
+  template <typename U>
+  friend bool operator==(const arena_allocator& left, const arena_allocator<U>& right) noexcept {
+    return left.get_arena() == right.get_arena();
+  }
+
+private:
+  arena* arena_;
+};
@@ -1,35 +1,284 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
 #include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <ranges>
 #include <type_traits>
+#include <utility>
 
+// Whether an object of type T can be moved to another address by copying its bytes, the source is then
+// treated as destroyed without calling its destructor. Specialize for types that keep no pointers into
+// themselves, such as containers holding their elements in separate storage.
 template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Default allocator of vector, the global operator new and operator delete. Unlike std::allocator it doesn't make
+// namespace std associated with vector<T>, so unqualified calls with vectors don't pick up functions of std.
+template <typename T>
+class new_allocator {
+public:
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  new_allocator() = default;
+
+  template <typename U>
+  new_allocator(const new_allocator<U>&) noexcept {}
+
+  T* allocate(size_t n) {
+    if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(operator new(sizeof(T) * n));
+  }
+
+  void deallocate(T* p, size_t) noexcept {
+    operator delete(p);
+  }
+
+  template <typename U>
+  friend bool operator==(const new_allocator&, const new_allocator<U>&) noexcept {
+    return true;
+  }
+};
+
+template <typename T, typename Allocator = new_allocator<T>>
 class vector {
 private:
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+  static_assert(std::is_same_v<typename alloc_traits::value_type, T>, "Allocator should allocate elements of T");
+  static_assert(std::is_same_v<typename alloc_traits::pointer, T*>, "Allocator should use raw pointers");
+
   T* data_;
   size_t size_;
   size_t capacity_;
+  [[no_unique_address]] Allocator alloc_;
 
-  vector(const vector& other, size_t new_capacity) : size_(0), capacity_(new_capacity) {
+  vector(const vector& other, size_t new_capacity, const Allocator& alloc)
+      : data_(nullptr),
+        size_(0),
+        capacity_(0),
+        alloc_(alloc) {
     assert(other.size() <= new_capacity && "new_capacity < size in vector copy constructor");
-    if (new_capacity == 0) {
-      data_ = nullptr;
-      return;
-    }
-    data_ = static_cast<T*>(operator new(sizeof(T) * new_capacity));
+    data_ = allocate(new_capacity);
+    capacity_ = new_capacity;
     try {
       for (; size() < other.size(); ++size_) {
-        new (end()) T(other[size()]);
+        construct(end(), other[size()]);
       }
     } catch (...) {
       clear();
-      operator delete(data());
+      deallocate(data(), capacity());
+      throw;
+    }
+  }
+
+  T* allocate(size_t capacity) {
+    if (capacity == 0) {
+      return nullptr;
+    }
+    return alloc_traits::allocate(alloc_, capacity);
+  }
+
+  void deallocate(T* data, size_t capacity) noexcept {
+    if (data != nullptr) {
+      alloc_traits::deallocate(alloc_, data, capacity);
+    }
+  }
+
+  template <typename... Args>
+  void construct(T* p, Args&&... args) {
+    alloc_traits::construct(alloc_, p, std::forward<Args>(args)...);
+  }
+
+  // Constructs count elements at the uninitialized storage at out from the ones at first, moving them if that
+  // can't throw and copying otherwise, so on exception the source is unchanged. The source elements are left to
+  // destroy_relocated().
+  void uninitialized_relocate(T* first, size_t count, T* out) {
+    if constexpr (is_trivially_relocatable_v<T>) {
+      if (count != 0) {
+        std::memcpy(static_cast<void*>(out), static_cast<const void*>(first), sizeof(T) * count);
+      }
+    } else {
+      size_t constructed = 0;
+      try {
+        for (; constructed < count; ++constructed) {
+          construct(out + constructed, std::move_if_noexcept(first[constructed]));
+        }
+      } catch (...) {
+        destroy(out, constructed);
+        throw;
+      }
+    }
+  }
+
+  // ends the lifetime of elements relocated by uninitialized_relocate()
+  void destroy_relocated(T* first, size_t count) noexcept {
+    if constexpr (!is_trivially_relocatable_v<T>) {
+      destroy(first, count);
+    }
+  }
+
+  // destroys in reverse order, the order opposite to the insertion
+  void destroy(T* first, size_t count) noexcept {
+    while (count != 0) {
+      --count;
+      alloc_traits::destroy(alloc_, first + count);
+    }
+  }
+
+  // constructs count copies of the elements from first at out, either all of them or none on exception
+  template <std::input_iterator It>
+  void uninitialized_copy(It first, size_t count, T* out) {
+    size_t constructed = 0;
+    try {
+      for (; constructed < count; ++constructed, ++first) {
+        construct(out + constructed, *first);
+      }
+    } catch (...) {
+      destroy(out, constructed);
+      throw;
+    }
+  }
+
+  size_t grown_capacity(size_t required) const noexcept {
+    return std::max(required, (capacity() == 0) ? 1 : capacity() * 2);
+  }
+
+  // Moves the elements to a new storage of new_capacity, leaving a gap of count elements at index that are
+  // constructed by fill(gap) with its own rollback. The gap is filled before any element is relocated, since the
+  // arguments of fill may refer to the elements. Provides the strong exception guarantee.
+  template <typename Fill>
+  void reallocate(size_t new_capacity, size_t index, size_t count, const Fill& fill) {
+    assert(size() + count <= new_capacity && index <= size());
+    T* new_data = allocate(new_capacity);
+    try {
+      fill(new_data + index);
+    } catch (...) {
+      deallocate(new_data, new_capacity);
+      throw;
+    }
+    try {
+      uninitialized_relocate(data(), index, new_data);
+      try {
+        uninitialized_relocate(data() + index, size() - index, new_data + index + count);
+      } catch (...) {
+        destroy(new_data, index);
+        throw;
+      }
+    } catch (...) {
+      destroy(new_data + index, count);
+      deallocate(new_data, new_capacity);
       throw;
     }
+    destroy_relocated(data(), size());
+    deallocate(data(), capacity());
+    data_ = new_data;
+    size_ += count;
+    capacity_ = new_capacity;
+  }
+
+  void reallocate(size_t new_capacity) {
+    reallocate(new_capacity, size(), 0, [](T*) {});
+  }
+
+  // Inserts count elements from first at index of a vector with enough capacity: the elements after index are
+  // shifted with a single pass of moves and the moved-from ones are assigned from the range.
+  template <std::forward_iterator It>
+  void insert_within_capacity(size_t index, It first, size_t count) {
+    assert(size() + count <= capacity());
+    T* pos = begin() + index;
+    T* old_end = end();
+    size_t tail = size() - index;
+    if (count < tail) {
+      for (T* it = old_end - count; it != old_end; ++it) {
+        construct(end(), std::move(*it));
+        ++size_;
+      }
+      std::move_backward(pos, old_end - count, old_end);
+      std::copy_n(first, count, pos);
+    } else {
+      It mid = std::next(first, tail);
+      for (It it = mid; size() != index + count; ++it) {
+        construct(end(), *it);
+        ++size_;
+      }
+      for (T* it = pos; it != old_end; ++it) {
+        construct(end(), std::move(*it));
+        ++size_;
+      }
+      std::copy(first, mid, pos);
+    }
+  }
+
+  template <std::input_iterator It, std::sentinel_for<It> Sentinel>
+  T* insert_range(size_t index, It first, Sentinel last) {
+    assert(index <= size() && "Index out of range in vector::insert()");
+    if constexpr (std::forward_iterator<It>) {
+      size_t count = std::ranges::distance(first, last);
+      if (size() + count > capacity()) {
+        reallocate(grown_capacity(size() + count), index, count,
+                   [&](T* gap) { uninitialized_copy(first, count, gap); });
+      } else {
+        insert_within_capacity(index, first, count);
+      }
+    } else {
+      // single pass, the elements are appended and rotated into place
+      size_t old_size = size();
+      for (; first != last; ++first) {
+        emplace_back(*first);
+      }
+      std::rotate(begin() + index, begin() + old_size, end());
+    }
+    return begin() + index;
+  }
+
+  // element constructed by the allocator outside of the storage
+  class temporary_value {
+  public:
+    template <typename... Args>
+    explicit temporary_value(Allocator& alloc, Args&&... args) : alloc_(alloc) {
+      alloc_traits::construct(alloc_, std::addressof(value_), std::forward<Args>(args)...);
+    }
+
+    temporary_value(const temporary_value&) = delete;
+    temporary_value& operator=(const temporary_value&) = delete;
+
+    ~temporary_value() noexcept {
+      alloc_traits::destroy(alloc_, std::addressof(value_));
+    }
+
+    T& get() noexcept {
+      return value_;
+    }
+
+  private:
+    Allocator& alloc_;
+
+    union {
+      T value_;
+    };
+  };
+
+  void swap_storage(vector& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(capacity_, other.capacity_);
   }
 
 public:
   using value_type = T;
+  using allocator_type = Allocator;
 
   using reference = T&;
   using const_reference = const T&;
@@ -41,22 +290,72 @@ public:
   using const_iterator = const_pointer;
 
 public:
-  vector() noexcept : data_(nullptr), size_(0), capacity_(0) {}
+  vector() noexcept(noexcept(Allocator())) : vector(Allocator()) {}
 
-  vector(const vector& other) : vector(other, other.size()) {}
+  explicit vector(const Allocator& alloc) noexcept : data_(nullptr), size_(0), capacity_(0), alloc_(alloc) {}
+
+  vector(const vector& other)
+      : vector(other, other.size(), alloc_traits::select_on_container_copy_construction(other.alloc_)) {}
+
+  vector(const vector& other, const Allocator& alloc) : vector(other, other.size(), alloc) {}
+
+  vector(vector&& other) noexcept
+      : data_(other.data_),
+        size_(other.size_),
+        capacity_(other.capacity_),
+        alloc_(std::move(other.alloc_)) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+  }
+
+  // takes the storage of other if it's allocated by an equal allocator, otherwise moves its elements
+  vector(vector&& other, const Allocator& alloc) : vector(alloc) {
+    if (alloc_ == other.alloc_) {
+      swap_storage(other);
+    } else {
+      reserve(other.size());
+      for (T& value : other) {
+        construct(end(), std::move(value));
+        ++size_;
+      }
+    }
+  }
 
   vector& operator=(const vector& other) {
     if (&other != this) {
-      vector(other).swap(*this);
+      if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+        vector copy(other, other.size(), other.alloc_);
+        swap_storage(copy);
+        std::swap(alloc_, copy.alloc_);
+      } else {
+        vector(other, alloc_).swap_storage(*this);
+      }
     }
     return *this;
   }
 
-  ~vector() noexcept {
-    if (data() != nullptr) {
-      clear();
-      operator delete(data());
+  vector& operator=(vector&& other) noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                                             alloc_traits::is_always_equal::value) {
+    if (&other != this) {
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+        vector moved(std::move(other));
+        swap_storage(moved);
+        std::swap(alloc_, moved.alloc_);
+      } else {
+        vector(std::move(other), alloc_).swap_storage(*this);
+      }
     }
+    return *this;
+  }
+
+  ~vector() noexcept {
+    clear();
+    deallocate(data(), capacity());
+  }
+
+  allocator_type get_allocator() const noexcept {
+    return alloc_;
   }
 
   reference operator[](size_t index) noexcept {
@@ -102,20 +401,33 @@ public:
   }
 
   void push_back(const T& value) {
-    if (size() + 1 <= capacity()) {
-      new (end()) T(value);
+    emplace_back(value);
+  }
+
+  void push_back(T&& value) {
+    emplace_back(std::move(value));
+  }
+
+  template <typename... Args>
+  reference emplace_back(Args&&... args) {
+    if (size() == capacity()) {
+      reallocate(grown_capacity(size() + 1), size(), 1, [&](T* gap) { construct(gap, std::forward<Args>(args)...); });
+    } else {
+      construct(end(), std::forward<Args>(args)...);
       ++size_;
-      return;
     }
-    size_t new_capacity = (capacity() == 0) ? 1 : capacity() * 2;
-    vector copy(*this, new_capacity);
-    copy.push_back(value);
-    swap(copy);
+    return back();
+  }
+
+  // appends the elements of range, reserving the storage once if its size is known
+  template <std::ranges::input_range R>
+  void append_range(R&& range) {
+    insert_range(size(), std::ranges::begin(range), std::ranges::end(range));
   }
 
   void pop_back() noexcept {
     assert(!empty() && "vector::pop_back() on empty vector");
-    back().~T();
+    alloc_traits::destroy(alloc_, end() - 1);
     --size_;
   }
 
@@ -129,13 +441,13 @@ public:
 
   void reserve(size_t new_capacity) {
     if (new_capacity > capacity()) {
-      vector(*this, new_capacity).swap(*this);
+      reallocate(new_capacity);
     }
   }
 
   void shrink_to_fit() {
     if (size() != capacity()) {
-      vector(*this, size()).swap(*this);
+      reallocate(size());
     }
   }
 
@@ -145,10 +457,14 @@ public:
     }
   }
 
+  // the allocators are swapped if they propagate on swap, otherwise they should be equal
   void swap(vector& other) noexcept {
-    std::swap(data_, other.data_);
-    std::swap(size_, other.size_);
-    std::swap(capacity_, other.capacity_);
+    if constexpr (alloc_traits::propagate_on_container_swap::value) {
+      std::swap(alloc_, other.alloc_);
+    } else {
+      assert(alloc_ == other.alloc_ && "Swapping vectors with unequal allocators");
+    }
+    swap_storage(other);
   }
 
   iterator begin() noexcept {
@@ -168,15 +484,38 @@ public:
   }
 
   iterator insert(const_iterator pos, const T& value) {
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  // the range shouldn't refer to the elements of the vector
+  template <std::input_iterator It>
+  iterator insert(const_iterator pos, It first, It last) {
+    return insert_range(pos - begin(), first, last);
+  }
+
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) {
     size_t index = pos - begin();
-    assert(index <= size() && "Index out of range in vector::insert()");
+    assert(index <= size() && "Index out of range in vector::emplace()");
 
-    push_back(value);
-    iterator new_pos = begin() + index;
-    for (iterator it = end() - 1; it != new_pos; --it) {
-      std::iter_swap(it, it - 1);
+    if (size() == capacity()) {
+      reallocate(grown_capacity(size() + 1), index, 1, [&](T* gap) { construct(gap, std::forward<Args>(args)...); });
+    } else if (index == size()) {
+      construct(end(), std::forward<Args>(args)...);
+      ++size_;
+    } else {
+      // constructed before the shift, since the arguments may refer to the elements
+      temporary_value value(alloc_, std::forward<Args>(args)...);
+      construct(end(), std::move(back()));
+      ++size_;
+      std::move_backward(begin() + index, end() - 2, end() - 1);
+      begin()[index] = std::move(value.get());
     }
-    return new_pos;
+    return begin() + index;
   }
 
   iterator erase(const_iterator pos) noexcept(noexcept(erase(pos, pos))) {
@@ -199,3 +538,9 @@ public:
     return begin() + index;
   }
 };
+
+// The elements are kept in separate storage, so copying the fields moves a vector, provided that the same holds
+// for its allocator.
+template <typename T, typename Allocator>
+struct is_trivially_relocatable<vector<T, Allocator>>
+    : std::bool_constant<std::is_empty_v<Allocator> || is_trivially_relocatable_v<Allocator>> {};
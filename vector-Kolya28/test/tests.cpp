@@ -1,8 +1,17 @@
+#include "arena.h"
 #include "element.h"
 #include "vector.h"
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
+#include <list>
+#include <memory_resource>
+#include <ranges>
+#include <sstream>
+#include <string>
+#include <utility>
+
 template class vector<int>;
 
 template <typename T>
@@ -500,6 +509,255 @@ TEST(correctness, last_copy_at_reallocation_throw) {
   check_reallocation_throw_at([](auto n) { return n + 1; });
 }
 
+namespace {
+
+template <bool NothrowMove>
+struct move_counting {
+  move_counting(size_t val) : val(val) {}
+
+  move_counting(const move_counting& other) : val(other.val) {
+    ++copies;
+  }
+
+  move_counting(move_counting&& other) noexcept(NothrowMove) : val(other.val) {
+    ++moves;
+  }
+
+  inline static size_t copies = 0;
+  inline static size_t moves = 0;
+
+  size_t val;
+};
+
+} // namespace
+
+TEST(correctness, reallocation_moves) {
+  using counting = move_counting<true>;
+  const size_t N = 5000;
+  {
+    vector<counting> a;
+    size_t copies = counting::copies;
+    for (size_t i = 0; i != N; ++i) {
+      const counting value(i);
+      a.push_back(value);
+    }
+    EXPECT_EQ(N, counting::copies - copies);
+    a.reserve(4 * N);
+    a.shrink_to_fit();
+    EXPECT_EQ(N, counting::copies - copies);
+    EXPECT_EQ(N, a.capacity());
+    for (size_t i = 0; i != N; ++i) {
+      EXPECT_EQ(i, a[i].val);
+    }
+  }
+}
+
+TEST(correctness, reallocation_copies_throwing_move) {
+  using counting = move_counting<false>;
+  vector<counting> a;
+  a.reserve(10);
+  for (size_t i = 0; i != a.capacity(); ++i) {
+    a.push_back(i);
+  }
+  size_t copies = counting::copies;
+  size_t moves = counting::moves;
+  const counting value(42);
+  a.push_back(value);
+  EXPECT_EQ(11, counting::copies - copies);
+  EXPECT_EQ(moves, counting::moves);
+}
+
+TEST(correctness, reallocation_strings) {
+  const size_t N = 5000;
+  vector<std::string> a;
+  for (size_t i = 0; i != N; ++i) {
+    a.push_back(std::to_string(i) + std::string(20, 'x'));
+    a.push_back(a.back());
+  }
+  for (size_t i = 0; i != N; ++i) {
+    EXPECT_EQ(std::to_string(i) + std::string(20, 'x'), a[2 * i]);
+    EXPECT_EQ(a[2 * i], a[2 * i + 1]);
+  }
+}
+
+TEST(correctness, reallocation_nested) {
+  vector<vector<element<size_t>>> a;
+  a.push_back(vector<element<size_t>>());
+  a[0].push_back(42);
+  const element<size_t>* inner = a[0].data();
+  size_t copies = element<size_t>::copy_counter;
+  for (size_t i = 0; i != 100; ++i) {
+    a.push_back(a[0]);
+  }
+  EXPECT_EQ(inner, a[0].data());
+  EXPECT_EQ(100, element<size_t>::copy_counter - copies);
+  EXPECT_EQ(42, a.back()[0]);
+  a.clear();
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, move_ctor) {
+  vector<element<size_t>> a;
+  for (size_t i = 0; i != 10; ++i) {
+    a.push_back(i);
+  }
+  element<size_t>* data = a.data();
+  size_t copies = element<size_t>::copy_counter;
+
+  vector<element<size_t>> b = std::move(a);
+  EXPECT_EQ(data, b.data());
+  EXPECT_EQ(10, b.size());
+  EXPECT_EQ(nullptr, a.data());
+  EXPECT_TRUE(a.empty());
+
+  a = std::move(b);
+  EXPECT_EQ(data, a.data());
+  EXPECT_EQ(0, b.capacity());
+  EXPECT_EQ(copies, element<size_t>::copy_counter);
+}
+
+TEST(correctness, push_back_rvalue) {
+  using counting = move_counting<true>;
+  vector<counting> a;
+  size_t copies = counting::copies;
+  for (size_t i = 0; i != 100; ++i) {
+    counting value(i);
+    a.push_back(std::move(value));
+  }
+  EXPECT_EQ(copies, counting::copies);
+  for (size_t i = 0; i != 100; ++i) {
+    EXPECT_EQ(i, a[i].val);
+  }
+}
+
+TEST(correctness, emplace_back) {
+  vector<std::pair<std::string, size_t>> a;
+  for (size_t i = 0; i != 100; ++i) {
+    auto& p = a.emplace_back(std::to_string(i), i);
+    EXPECT_EQ(&a.back(), &p);
+  }
+  a.emplace_back();
+  for (size_t i = 0; i != 100; ++i) {
+    EXPECT_EQ(std::to_string(i), a[i].first);
+    EXPECT_EQ(i, a[i].second);
+  }
+  EXPECT_TRUE(a.back().first.empty());
+}
+
+TEST(correctness, emplace) {
+  const size_t N = 100;
+  {
+    vector<element<size_t>> a;
+    for (size_t i = 0; i != N; ++i) {
+      auto it = a.emplace(a.begin() + a.size() / 2, i);
+      EXPECT_EQ(i, *it);
+    }
+    EXPECT_EQ(N, a.size());
+
+    // the argument refers to an element, both when reallocating and shifting
+    a.shrink_to_fit();
+    a.emplace(a.begin(), a.back());
+    EXPECT_EQ(a.back(), a.front());
+    a.emplace(a.begin() + 1, a.back());
+    EXPECT_EQ(a.back(), a[1]);
+    a.emplace(a.end(), a[0]);
+    EXPECT_EQ(a.front(), a.back());
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, insert_range) {
+  const size_t N = 50;
+  for (size_t count : {0, 1, 10, 40, 60}) {
+    for (size_t index : {size_t(0), N / 2, N}) {
+      for (bool reserve : {false, true}) {
+        {
+          vector<element<size_t>> a;
+          for (size_t i = 0; i != N; ++i) {
+            a.push_back(i);
+          }
+          if (reserve) {
+            a.reserve(N + count);
+          }
+          vector<element<size_t>> b;
+          for (size_t i = 0; i != count; ++i) {
+            b.push_back(1000 + i);
+          }
+
+          auto it = a.insert(a.begin() + index, b.begin(), b.end());
+          EXPECT_EQ(a.begin() + index, it);
+          ASSERT_EQ(N + count, a.size());
+          for (size_t i = 0; i != a.size(); ++i) {
+            size_t expected = i < index ? i : i < index + count ? 1000 + i - index : i - count;
+            EXPECT_EQ(expected, a[i]);
+          }
+        }
+        element<size_t>::expect_no_instances();
+      }
+    }
+  }
+}
+
+TEST(correctness, insert_range_single_reallocation) {
+  vector<element<size_t>> records;
+  for (size_t i = 0; i != 10000; ++i) {
+    records.push_back(i);
+  }
+
+  vector<element<size_t>> a;
+  a.push_back(0);
+  size_t copies = element<size_t>::copy_counter;
+  a.insert(a.begin(), records.begin(), records.end());
+  EXPECT_EQ(10001, a.capacity());
+  EXPECT_EQ(10001, element<size_t>::copy_counter - copies);
+}
+
+TEST(correctness, insert_input_range) {
+  std::istringstream input("1 2 3 4 5");
+  vector<int> a;
+  a.push_back(0);
+  a.push_back(6);
+  auto it = a.insert(a.begin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+  EXPECT_EQ(a.begin() + 1, it);
+  ASSERT_EQ(7, a.size());
+  for (int i = 0; i != 7; ++i) {
+    EXPECT_EQ(i, a[i]);
+  }
+}
+
+TEST(correctness, insert_range_throw) {
+  {
+    vector<element<size_t>> a;
+    for (size_t i = 0; i != 10; ++i) {
+      a.push_back(i);
+    }
+    a.shrink_to_fit();
+    vector<element<size_t>> b;
+    for (size_t i = 0; i != 10; ++i) {
+      b.push_back(100 + i);
+    }
+    element<size_t>::set_throw_countdown(15);
+    EXPECT_THROW(a.insert(a.begin() + 5, b.begin(), b.end()), std::runtime_error);
+    EXPECT_EQ(10, a.size());
+    EXPECT_EQ(10, a.capacity());
+    for (size_t i = 0; i != 10; ++i) {
+      EXPECT_EQ(i, a[i]);
+    }
+  }
+  element<size_t>::expect_no_instances();
+}
+
+TEST(correctness, append_range) {
+  vector<std::string> a;
+  a.append_range(std::list<std::string>{"a", "b", "c"});
+  EXPECT_EQ(3, a.capacity());
+  a.append_range(std::views::iota(0, 5) | std::views::transform([](int i) { return std::to_string(i); }));
+  a.append_range(vector<std::string>());
+  ASSERT_EQ(8, a.size());
+  EXPECT_EQ("c", a[2]);
+  EXPECT_EQ("4", a.back());
+}
+
 TEST(correctness, empty_storage) {
   vector<int> a;
   EXPECT_EQ(nullptr, a.data());
@@ -566,3 +824,194 @@ TEST(correctness, ctor_alloc) {
   auto b = a;
   EXPECT_EQ(1, b.capacity());
 }
+
+namespace {
+
+struct allocation_counters {
+  size_t allocations = 0;
+  size_t deallocations = 0;
+};
+
+// allocators with different ids can't free each other's storage
+template <typename T, bool Propagate>
+class counting_allocator {
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::bool_constant<Propagate>;
+  using propagate_on_container_move_assignment = std::bool_constant<Propagate>;
+  using propagate_on_container_swap = std::bool_constant<Propagate>;
+
+  counting_allocator(allocation_counters* counters, int id) noexcept : counters_(counters), id_(id) {}
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U, Propagate>& other) noexcept
+      : counters_(other.counters()),
+        id_(other.id()) {}
+
+  T* allocate(size_t n) {
+    ++counters_->allocations;
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    ++counters_->deallocations;
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  allocation_counters* counters() const noexcept {
+    return counters_;
+  }
+
+  int id() const noexcept {
+    return id_;
+  }
+
+  template <typename U>
+  friend bool operator==(const counting_allocator& a, const counting_allocator<U, Propagate>& b) noexcept {
+    return a.id() == b.id();
+  }
+
+private:
+  allocation_counters* counters_;
+  int id_;
+};
+
+bool inside(const void* p, const void* buffer, size_t size) {
+  auto address = reinterpret_cast<std::uintptr_t>(p);
+  auto first = reinterpret_cast<std::uintptr_t>(buffer);
+  return first <= address && address < first + size;
+}
+
+} // namespace
+
+TEST(allocator, stateful) {
+  using alloc = counting_allocator<element<size_t>, false>;
+  allocation_counters counters;
+  {
+    vector<element<size_t>, alloc> a(alloc(&counters, 1));
+    for (size_t i = 0; i != 100; ++i) {
+      a.push_back(i);
+    }
+    EXPECT_EQ(8, counters.allocations);
+    EXPECT_EQ(1, a.get_allocator().id());
+
+    vector<element<size_t>, alloc> b(alloc(&counters, 2));
+    b.push_back(42);
+    b = a;
+    EXPECT_EQ(2, b.get_allocator().id());
+    EXPECT_EQ(100, b.size());
+
+    // unequal allocators that don't propagate, the elements are moved to the storage of c
+    vector<element<size_t>, alloc> c(alloc(&counters, 3));
+    element<size_t>* data = b.data();
+    c = std::move(b);
+    EXPECT_EQ(3, c.get_allocator().id());
+    EXPECT_NE(data, c.data());
+
+    data = a.data();
+    vector<element<size_t>, alloc> d(alloc(&counters, 1));
+    d = std::move(a);
+    EXPECT_EQ(data, d.data());
+
+    vector<element<size_t>, alloc> e(std::move(d), alloc(&counters, 4));
+    EXPECT_EQ(4, e.get_allocator().id());
+    for (size_t i = 0; i != 100; ++i) {
+      EXPECT_EQ(i, e[i]);
+    }
+  }
+  EXPECT_EQ(counters.allocations, counters.deallocations);
+  element<size_t>::expect_no_instances();
+}
+
+TEST(allocator, propagating) {
+  using alloc = counting_allocator<int, true>;
+  allocation_counters counters;
+  {
+    vector<int, alloc> a(alloc(&counters, 1));
+    a.push_back(1);
+    vector<int, alloc> b(alloc(&counters, 2));
+    b.push_back(2);
+
+    b = a;
+    EXPECT_EQ(1, b.get_allocator().id());
+    vector<int, alloc> c(alloc(&counters, 3));
+    c = std::move(b);
+    EXPECT_EQ(1, c.get_allocator().id());
+    c.swap(a);
+    EXPECT_EQ(1, a[0]);
+  }
+  EXPECT_EQ(counters.allocations, counters.deallocations);
+}
+
+TEST(allocator, memory_resource) {
+  alignas(std::max_align_t) std::byte buffer[1 << 16];
+  std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+  using pmr_vector = vector<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>>;
+
+  pmr_vector a(&resource);
+  for (size_t i = 0; i != 100; ++i) {
+    a.emplace_back(std::string(40, 'a' + i % 26));
+  }
+  a.emplace(a.begin(), "first");
+  EXPECT_TRUE(inside(a.data(), buffer, sizeof(buffer)));
+  // the elements are constructed with the allocator of the vector
+  EXPECT_EQ(&resource, a[0].get_allocator().resource());
+  EXPECT_EQ(&resource, a[1].get_allocator().resource());
+  EXPECT_TRUE(inside(a[1].data(), buffer, sizeof(buffer)));
+  EXPECT_EQ("first", a[0]);
+  EXPECT_EQ(std::string(40, 'a'), std::string_view(a[1]));
+}
+
+TEST(allocator, arena) {
+  arena storage(256);
+  {
+    vector<size_t, arena_allocator<size_t>> a(storage);
+    vector<size_t, arena_allocator<size_t>> b(storage);
+    for (size_t i = 0; i != 10000; ++i) {
+      a.push_back(i);
+      b.push_back(2 * i);
+    }
+    for (size_t i = 0; i != 10000; ++i) {
+      EXPECT_EQ(i, a[i]);
+      EXPECT_EQ(2 * i, b[i]);
+    }
+    EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(a.data()) % alignof(size_t));
+    a.swap(b);
+    EXPECT_EQ(0, a[1] % 2);
+  }
+  storage.release();
+
+  alignas(std::max_align_t) std::byte buffer[1024];
+  arena local(buffer, sizeof(buffer));
+  vector<vector<element<size_t>>, arena_allocator<vector<element<size_t>>>> c(local);
+  c.reserve(4);
+  EXPECT_TRUE(inside(c.data(), buffer, sizeof(buffer)));
+  for (size_t i = 0; i != 100; ++i) {
+    c.emplace_back().push_back(i);
+  }
+  EXPECT_FALSE(inside(c.data(), buffer, sizeof(buffer)));
+  EXPECT_EQ(99, c.back()[0]);
+  c.clear();
+  element<size_t>::expect_no_instances();
+}
+
+TEST(allocator, arena_alignment) {
+  arena storage(16);
+  for (size_t alignment : {1, 2, 8, 16, 64, 256}) {
+    void* p = storage.allocate(3, alignment);
+    EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(p) % alignment);
+  }
+  void* p = storage.allocate(100000);
+  storage.deallocate(p, 100000);
+  EXPECT_EQ(p, storage.allocate(10));
+}
+
+TEST(allocator, traits) {
+  EXPECT_EQ(3 * sizeof(size_t), sizeof(vector<int>));
+  EXPECT_TRUE((std::is_same_v<new_allocator<int>, vector<int>::allocator_type>));
+  EXPECT_TRUE(is_trivially_relocatable_v<vector<std::string>>);
+  EXPECT_TRUE((is_trivially_relocatable_v<vector<int, arena_allocator<int>>>));
+  EXPECT_TRUE((is_trivially_relocatable_v<vector<int, std::pmr::polymorphic_allocator<int>>>));
+  EXPECT_TRUE(std::is_nothrow_move_assignable_v<vector<int>>);
+  EXPECT_FALSE((std::is_nothrow_move_assignable_v<vector<int, arena_allocator<int>>>));
+}